@@ -0,0 +1,179 @@
+// Benchmark suite for PostMachine::step()/run() on canonical programs.
+//
+//   g++ -O2 -std=c++20 -Isrc bench/bench_post.cpp src/*.cpp -pthread -o bench_post
+//   ./bench_post          > bench_post.csv
+//   ./bench_post --json   > bench_post.json
+//
+// Programs: unary addition, unary multiplication, binary increment,
+// palindrome checking and random rule sets. Each one is swept over tape
+// length (and rule count for the random sets) and every backend that suits
+// it. Every run checks its final tape; a wrong answer is reported on stderr
+// and ends the suite with exit code 1. Columns: program, backend, tape_len,
+// rules, steps, ns_per_step, steps_per_sec, tape_high_water. The high water
+// is the longest tape of that run alone, taken by RuleProfiler on a second,
+// untimed run so the profiling does not skew the timing.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/PostMachine.h"
+#include "../src/PostProfiler.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct RuleSpec {
+    std::string pattern;
+    std::string replace;
+    bool moveRight = true;
+};
+
+struct Program {
+    std::string name;
+    std::string tape;
+    std::vector<RuleSpec> rules;
+    std::string expected;  // final tape; empty = not checked
+    int maxSteps = -1;
+};
+
+const char* backendName(TapeBackend backend) {
+    switch (backend) {
+    case TapeBackend::GapBuffer: return "gap";
+    case TapeBackend::Rope: return "rope";
+    case TapeBackend::RunLength: return "rle";
+    case TapeBackend::File: return "file";
+    default: return "string";
+    }
+}
+
+// 1^a+1^b= -> 1^(a+b)=
+Program unaryAdd(size_t a, size_t b) {
+    return {"unary_add", std::string(a, '1') + "+" + std::string(b, '1') + "=",
+            {{"1+", "+1"}, {"+", "", false}},
+            std::string(a + b, '1') + "="};
+}
+
+// 1^a*1^b= -> 1^(a*b). Every 1 left of '*' becomes a carrier A that walks
+// over the right operand, sending one x per symbol to the result after '='.
+Program unaryMult(size_t a, size_t b) {
+    return {"unary_mult", std::string(a, '1') + "*" + std::string(b, '1') + "=",
+            {{"x1", "1x"}, {"x=", "=1"}, {"A1", "1Ax"}, {"A=", "="},
+             {"1*", "*A"}, {"*1", "*"}, {"*=", "", false}},
+            std::string(a * b, '1')};
+}
+
+// 01^n+ -> 10^n: the carry ripples through every digit.
+Program binaryIncrement(size_t n) {
+    return {"binary_inc", "0" + std::string(n, '1') + "+",
+            {{"0+", "1", false}, {"1+", "+0", false}, {"+", "1", false}},
+            "1" + std::string(n, '0')};
+}
+
+// ^w$ -> Y if w over {a,b} is a palindrome, N otherwise. The first symbol
+// is picked up by a carrier that compares it with the last one.
+Program palindrome(size_t n, bool spoil) {
+    std::string w(n, 'a');
+    for (size_t i = 0; i < n / 2; ++i) w[i] = w[n - 1 - i] = "ab"[(i * 7 / 3) % 2];
+    if (spoil && n > 1) w[n - 1] = w[0] == 'a' ? 'b' : 'a';
+    return {spoil ? "palindrome_no" : "palindrome_yes", "^" + w + "$",
+            {{"aN", "N", false}, {"bN", "N", false}, {"^N", "N", false},
+             {"aA$", "$", false}, {"bB$", "$", false}, {"bA$", "N"}, {"aB$", "N"},
+             {"^A$", "Y"}, {"^B$", "Y"},
+             {"Aa", "aA"}, {"Ab", "bA"}, {"Ba", "aB"}, {"Bb", "bB"},
+             {"^a", "^A", false}, {"^b", "^B", false}, {"^$", "Y"}},
+            spoil ? "N" : "Y"};
+}
+
+// Random patterns of 1-4 symbols over "abc", rewritten to 0-3 symbols.
+Program randomRules(size_t tapeLength, size_t ruleCount, std::mt19937& rng) {
+    Program p{"random", std::string(tapeLength, 'a'), {}, "", 20000};
+    for (char& c : p.tape) c = "abc"[rng() % 3];
+    for (size_t r = 0; r < ruleCount; ++r) {
+        RuleSpec rule;
+        rule.pattern.resize(1 + rng() % 4);
+        for (char& c : rule.pattern) c = "abc"[rng() % 3];
+        rule.replace.resize(rng() % 4);
+        for (char& c : rule.replace) c = "abc"[rng() % 3];
+        rule.moveRight = rng() % 2;
+        p.rules.push_back(rule);
+    }
+    return p;
+}
+
+bool g_json = false;
+bool g_first = true;
+
+PostMachine load(const Program& program, TapeBackend backend) {
+    PostMachine pm(program.tape, backend);
+    for (const RuleSpec& rule : program.rules) pm.addRule(rule.pattern, rule.replace, rule.moveRight);
+    return pm;
+}
+
+void measure(const Program& program, TapeBackend backend) {
+    PostMachine pm = load(program, backend);
+    auto start = Clock::now();
+    pm.run(program.maxSteps);
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    if (!program.expected.empty() && pm.tape() != program.expected) {
+        std::fprintf(stderr, "%s on %s (tape %zu): wrong result\n", program.name.c_str(),
+                     backendName(backend), program.tape.size());
+        std::exit(1);
+    }
+    RuleProfiler profiler;
+    PostMachine profiled = load(program, backend);
+    profiled.run(program.maxSteps, profiler);
+    size_t highWater = profiler.tapeHighWater();
+
+    size_t steps = pm.steps();
+    double nsPerStep = steps ? ns / steps : 0.0;
+    double perSec = ns > 0 ? steps * 1e9 / ns : 0.0;
+    if (g_json) {
+        std::printf("%s\n  {\"program\": \"%s\", \"backend\": \"%s\", \"tape_len\": %zu, \"rules\": %zu, "
+                    "\"steps\": %zu, \"ns_per_step\": %.1f, \"steps_per_sec\": %.0f, \"tape_high_water\": %zu}",
+                    g_first ? "[" : ",", program.name.c_str(), backendName(backend), program.tape.size(),
+                    program.rules.size(), steps, nsPerStep, perSec, highWater);
+    } else {
+        std::printf("%s,%s,%zu,%zu,%zu,%.1f,%.0f,%zu\n", program.name.c_str(), backendName(backend),
+                    program.tape.size(), program.rules.size(), steps, nsPerStep, perSec, highWater);
+    }
+    g_first = false;
+}
+
+}
+
+int main(int argc, char** argv) {
+    g_json = argc > 1 && std::strcmp(argv[1], "--json") == 0;
+    if (!g_json) std::printf("program,backend,tape_len,rules,steps,ns_per_step,steps_per_sec,tape_high_water\n");
+
+    const std::vector<TapeBackend> backends{TapeBackend::String, TapeBackend::GapBuffer, TapeBackend::Rope};
+    for (size_t n = 1 << 10; n <= (size_t(1) << 20); n *= 8) {
+        for (TapeBackend backend : backends) measure(unaryAdd(n, n), backend);
+        measure(unaryAdd(n, n), TapeBackend::RunLength);
+    }
+    for (size_t n = 16; n <= 128; n *= 2)
+        for (TapeBackend backend : backends) measure(unaryMult(n, n), backend);
+    for (size_t n = 1 << 10; n <= (size_t(1) << 16); n *= 4)
+        for (TapeBackend backend : backends) measure(binaryIncrement(n), backend);
+    for (size_t n = 256; n <= 2048; n *= 2)
+        for (TapeBackend backend : backends) {
+            measure(palindrome(n, false), backend);
+            measure(palindrome(n, true), backend);
+        }
+
+    std::mt19937 rng(3);
+    for (size_t length = 1 << 10; length <= (size_t(1) << 18); length *= 16)
+        for (size_t rules = 4; rules <= 256; rules *= 4) {
+            Program program = randomRules(length, rules, rng);
+            for (TapeBackend backend : backends) measure(program, backend);
+        }
+
+    if (g_json) std::printf("%s]\n", g_first ? "[" : "\n");
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Rect2D text and binary I/O throughput: the stream operators against
+// parseRects()/formatRects() and a mapped RectFile.
+//
+//   g++ -O2 -std=c++20 -Isrc bench/bench_rectio.cpp src/Rect2D.cpp src/RectSet.cpp src/SimdSearch.cpp src/RectText.cpp src/RectFile.cpp src/MappedFile.cpp -o bench_rectio
+//   ./bench_rectio [rects] > bench_rectio.csv
+//
+// Coordinates are uniform over +-1e6. Output is CSV:
+// method,rects,bytes,seconds,mb_per_s
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/RectFile.h"
+#include "../src/RectText.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template<class Fn>
+void report(const char* method, size_t rects, size_t bytes, Fn fn) {
+    auto start = Clock::now();
+    if (!fn()) {
+        std::fprintf(stderr, "%s: wrong result\n", method);
+        std::exit(1);
+    }
+    double s = std::chrono::duration<double>(Clock::now() - start).count();
+    std::printf("%s,%zu,%zu,%.4f,%.1f\n", method, rects, bytes, s, bytes / s / 1e6);
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coord(-1000000, 1000000);
+    std::vector<Rect2D> rects;
+    rects.reserve(n);
+    for (size_t i = 0; i < n; ++i) rects.emplace_back(coord(rng), coord(rng), coord(rng), coord(rng));
+
+    std::string text;
+    formatRects(rects, text);
+    std::printf("method,rects,bytes,seconds,mb_per_s\n");
+    report("ostream", n, text.size(), [&] {
+        std::ostringstream os;
+        for (const Rect2D& r : rects) os << r << '\n';
+        return os.str() == text;
+    });
+    report("formatRects", n, text.size(), [&] {
+        std::string out;
+        formatRects(rects, out);
+        return out == text;
+    });
+    report("istream", n, text.size(), [&] {
+        std::istringstream is(text);
+        std::vector<Rect2D> out;
+        for (Rect2D r; is >> r;) out.push_back(r);
+        return out == rects;
+    });
+    report("parseRects", n, text.size(), [&] {
+        std::vector<Rect2D> out;
+        return parseRects(text, out).ok && out == rects;
+    });
+    report("parseRects_set", n, text.size(), [&] {
+        RectSet out;
+        return parseRects(text, out).ok && out.size() == n;
+    });
+
+    std::string path = "bench_rectio.bin";
+    if (!saveRects(path, rects)) return 1;
+    report("RectFile", n, n * sizeof(Rect2D), [&] {
+        RectFile file(path);
+        std::span<const Rect2D> loaded = file.rects();
+        return std::equal(loaded.begin(), loaded.end(), rects.begin(), rects.end());
+    });
+    std::remove(path.c_str());
+}
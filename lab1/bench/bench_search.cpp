@@ -0,0 +1,100 @@
+// Microbenchmark of the rule search kernels.
+//
+//   g++ -O2 -std=c++20 -Isrc bench/bench_search.cpp src/SimdSearch.cpp -o bench_search
+//   ./bench_search > bench_output.txt
+//
+// For tape sizes from 1 KB to 100 MB it times std::string::find against
+// simdFind() at every supported level, per pattern length, and the
+// find-based step() loop (try each rule in order on the whole tape) with
+// either search. Output is CSV: kind,level,tape_bytes,pattern_len,ns_per_call,mb_per_s
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/SimdSearch.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* levelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2: return "avx2";
+    case SimdLevel::SSE2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+// Unary-style tape: long runs of '1' split by '_', with the pattern planted
+// near the end so every search walks almost the whole tape.
+std::string makeTape(size_t bytes, const std::string& pattern, std::mt19937& rng) {
+    std::string tape(bytes, '1');
+    for (size_t i = 0; i < bytes; i += 1 + rng() % 64) tape[i] = '_';
+    if (bytes > pattern.size()) tape.replace(bytes - pattern.size() - 1, pattern.size(), pattern);
+    return tape;
+}
+
+template<class Search>
+double nsPerCall(size_t bytes, Search search) {
+    size_t reps = std::max<size_t>(1, (size_t(16) << 20) / bytes);
+    size_t sink = 0;
+    auto start = Clock::now();
+    for (size_t r = 0; r < reps; ++r) sink += search();
+    auto ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    if (sink == 42) std::fprintf(stderr, " ");
+    return ns / reps;
+}
+
+void report(const char* kind, const char* level, size_t bytes, size_t len, double ns) {
+    std::printf("%s,%s,%zu,%zu,%.1f,%.1f\n", kind, level, bytes, len, ns, bytes / ns * 1e3);
+}
+
+}
+
+int main() {
+    std::mt19937 rng(1);
+    std::vector<SimdLevel> levels{SimdLevel::Scalar};
+    if (simdLevel() != SimdLevel::Scalar) levels.push_back(SimdLevel::SSE2);
+    if (simdLevel() == SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+    // Rule patterns of a unary program; the last one is the planted match.
+    const std::vector<std::string> rules{"1#1", "#_", "_1#", "11#_1", "1_11"};
+
+    std::printf("kind,level,tape_bytes,pattern_len,ns_per_call,mb_per_s\n");
+    for (size_t bytes = 1 << 10; bytes <= size_t(100) << 20; bytes *= 4) {
+        if (bytes > (size_t(64) << 20)) bytes = size_t(100) << 20;
+        for (size_t len = 1; len <= 8; ++len) {
+            std::string pattern(len, '1');
+            pattern[len / 2] = '#';
+            std::string tape = makeTape(bytes, pattern, rng);
+            report("find", "std", bytes, len, nsPerCall(bytes, [&] { return tape.find(pattern); }));
+            for (SimdLevel level : levels) {
+                report("find", levelName(level), bytes, len, nsPerCall(bytes, [&] {
+                    return simdFind(tape.data(), tape.size(), pattern.data(), pattern.size(), level);
+                }));
+            }
+        }
+
+        std::string tape = makeTape(bytes, rules.back(), rng);
+        auto stepWith = [&](auto search) {
+            for (const auto& rule : rules) {
+                size_t pos = search(rule);
+                if (pos != std::string::npos) return pos;
+            }
+            return std::string::npos;
+        };
+        report("step", "std", bytes, rules.size(), nsPerCall(bytes, [&] {
+            return stepWith([&](const std::string& p) { return tape.find(p); });
+        }));
+        for (SimdLevel level : levels) {
+            report("step", levelName(level), bytes, rules.size(), nsPerCall(bytes, [&] {
+                return stepWith([&](const std::string& p) {
+                    return simdFind(tape.data(), tape.size(), p.data(), p.size(), level);
+                });
+            }));
+        }
+        if (bytes == (size_t(100) << 20)) break;
+    }
+    return 0;
+}
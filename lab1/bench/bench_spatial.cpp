@@ -0,0 +1,97 @@
+// Spatial index benchmark: RTree and RectGrid against a linear scan.
+//
+//   g++ -O2 -std=c++20 -Isrc bench/bench_spatial.cpp src/Rect2D.cpp src/RTree.cpp src/RectGrid.cpp -o bench_spatial
+//   ./bench_spatial > bench_spatial.csv
+//
+// Rectangles of 1-64 units are scattered over a square that keeps the
+// density constant as their number grows. Output is CSV:
+// index,rects,operation,ns_per_op,ops_per_s
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../src/RTree.h"
+#include "../src/RectGrid.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Query {
+    int x, y;
+    Rect2D window;
+};
+
+template<class Fn>
+void report(const char* index, size_t rects, const char* op, size_t count, Fn fn) {
+    auto start = Clock::now();
+    size_t sink = 0;
+    for (size_t i = 0; i < count; ++i) sink += fn(i);
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+    if (sink == 42) std::fprintf(stderr, " ");
+    std::printf("%s,%zu,%s,%.1f,%.0f\n", index, rects, op, ns, 1e9 / ns);
+}
+
+template<class Index>
+void run(const char* name, const std::vector<Rect2D>& rects, const std::vector<Query>& queries) {
+    std::vector<uint32_t> out;
+    Index* index = nullptr;
+    report(name, rects.size(), "build", 1, [&](size_t) { index = new Index(rects); return size_t(0); });
+    report(name, rects.size(), "point", queries.size(), [&](size_t i) {
+        out.clear();
+        index->queryPoint(queries[i].x, queries[i].y, out);
+        return out.size();
+    });
+    report(name, rects.size(), "window", queries.size(), [&](size_t i) {
+        out.clear();
+        index->queryWindow(queries[i].window, out);
+        return out.size();
+    });
+    report(name, rects.size(), "knn8", queries.size(), [&](size_t i) {
+        out.clear();
+        index->nearest(queries[i].x, queries[i].y, 8, out);
+        return out.size();
+    });
+    report(name, rects.size(), "update", queries.size(), [&](size_t i) {
+        uint32_t id = static_cast<uint32_t>(i * 7919 % rects.size());
+        Rect2D r = index->rect(id);
+        r.move(3, -2);
+        return size_t(index->update(id, r));
+    });
+    delete index;
+}
+
+}
+
+int main() {
+    std::mt19937 rng(4);
+    std::printf("index,rects,operation,ns_per_op,ops_per_s\n");
+    for (size_t n = 10000; n <= 1000000; n *= 10) {
+        int side = static_cast<int>(std::sqrt(double(n)) * 40);
+        std::uniform_int_distribution<int> coord(0, side), size(1, 64);
+        std::vector<Rect2D> rects;
+        for (size_t i = 0; i < n; ++i) {
+            int x = coord(rng), y = coord(rng);
+            rects.emplace_back(x, y, x + size(rng), y + size(rng));
+        }
+        std::vector<Query> queries(100000);
+        for (Query& q : queries) {
+            q.x = coord(rng);
+            q.y = coord(rng);
+            q.window = Rect2D(q.x, q.y, q.x + 100, q.y + 100);
+        }
+        run<RTree>("rtree", rects, queries);
+        run<RectGrid>("grid", rects, queries);
+
+        std::vector<uint32_t> out;
+        report("scan", n, "window", 200, [&](size_t i) {
+            out.clear();
+            for (uint32_t id = 0; id < rects.size(); ++id)
+                if (!((rects[id] - queries[i].window) == Rect2D(0, 0, 0, 0))) out.push_back(id);
+            return out.size();
+        });
+    }
+    return 0;
+}
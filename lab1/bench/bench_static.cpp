@@ -0,0 +1,71 @@
+// StaticPostMachine against PostMachine on the programs of tests/test_post.cpp.
+//
+//   g++ -O2 -std=c++20 -Isrc bench/bench_static.cpp src/*.cpp -pthread -o bench_static
+//   ./bench_static > bench_static.csv
+//
+// Every program runs to completion on tapes of growing size with both
+// machines; the final tapes are compared. Output is CSV:
+// program,machine,tape_len,steps,ns_per_step
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../src/PostMachine.h"
+#include "../src/StaticPostMachine.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Timing {
+    std::string tape;
+    size_t steps;
+    double ns;
+};
+
+template<class Machine, class Setup>
+Timing timeRun(const std::string& tape, Setup setup) {
+    Machine pm(tape);
+    setup(pm);
+    auto start = Clock::now();
+    pm.run();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return {pm.tape(), pm.steps(), ns};
+}
+
+template<class Static>
+void compare(const char* program, const std::string& tape,
+             const std::vector<std::pair<std::string, std::string>>& rules, bool lastStays) {
+    Timing fixed = timeRun<Static>(tape, [](Static&) {});
+    Timing dynamic = timeRun<PostMachine>(tape, [&](PostMachine& pm) {
+        for (size_t i = 0; i < rules.size(); ++i)
+            pm.addRule(rules[i].first, rules[i].second, !(lastStays && i + 1 == rules.size()));
+    });
+    if (fixed.tape != dynamic.tape || fixed.steps != dynamic.steps)
+        std::fprintf(stderr, "%s: machines disagree at tape length %zu\n", program, tape.size());
+    for (const auto& [name, t] : {std::pair{"static", fixed}, std::pair{"dynamic", dynamic}})
+        std::printf("%s,%s,%zu,%zu,%.1f\n", program, name, tape.size(), t.steps,
+                    t.steps ? t.ns / t.steps : 0.0);
+}
+
+using UnaryAdd = StaticPostMachine<StaticRule<"1+", "+1">, StaticRule<"+", "", false>>;
+using Collapse = StaticPostMachine<StaticRule<"aa", "b">, StaticRule<"a", "z">>;
+using Erase = StaticPostMachine<StaticRule<"1_", "_">>;
+using Countdown = StaticPostMachine<StaticRule<"1*", "*">, StaticRule<"*11=", "=", false>>;
+
+}
+
+int main() {
+    std::printf("program,machine,tape_len,steps,ns_per_step\n");
+    for (size_t n = 1 << 8; n <= (size_t(1) << 16); n *= 4) {
+        compare<UnaryAdd>("unary_add", std::string(n, '1') + "+" + std::string(n, '1') + "=",
+                          {{"1+", "+1"}, {"+", ""}}, true);
+        compare<Collapse>("collapse", std::string(n, 'a'), {{"aa", "b"}, {"a", "z"}}, false);
+        compare<Erase>("erase", std::string(n, '1') + "_", {{"1_", "_"}}, false);
+        compare<Countdown>("countdown", std::string(n, '1') + "*11=",
+                           {{"1*", "*"}, {"*11=", "="}}, true);
+    }
+    return 0;
+}
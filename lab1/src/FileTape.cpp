@@ -0,0 +1,368 @@
+#include "FileTape.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+std::atomic<unsigned> s_fileCounter{0};
+
+std::string uniqueSuffix() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    return std::to_string(now) + "-" + std::to_string(s_fileCounter++);
+}
+
+// A fresh file name in the temporary directory, where working and spill
+// files go regardless of where the tape came from; empty if there is none.
+std::string workingPath(const char* extension) {
+    std::error_code ec;
+    auto dir = std::filesystem::temp_directory_path(ec);
+    if (ec) return std::string();
+    return (dir / ("posttape-" + uniqueSuffix() + extension)).string();
+}
+
+}
+
+FileTape::Segment::~Segment() {
+    map.close();
+    if (owned) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+}
+
+std::shared_ptr<const FileTape::Segment> FileTape::openSegment(const std::string& path, bool owned) {
+    auto segment = std::make_shared<Segment>();
+    segment->path = path;
+    segment->owned = owned;
+    if (!segment->map.open(path)) return nullptr;
+    segment->size = segment->map.size();
+    return segment;
+}
+
+std::shared_ptr<const FileTape::Segment> FileTape::openSegment(const std::string& path, size_t start, size_t size) {
+    auto segment = std::make_shared<Segment>();
+    segment->path = path;
+    if (!segment->map.open(path) || start > segment->map.size() || size > segment->map.size() - start)
+        return nullptr;
+    segment->start = start;
+    segment->size = size;
+    return segment;
+}
+
+std::unique_ptr<FileTape> FileTape::adopt(std::shared_ptr<const Segment> segment) {
+    if (!segment) return nullptr;
+    std::unique_ptr<FileTape> tape(new FileTape());
+    size_t size = segment->size;
+    tape->m_segments.push_back(std::move(segment));
+    if (size) tape->m_root = tape->newNode({0, 0, size});
+    return tape;
+}
+
+std::unique_ptr<FileTape> FileTape::open(const std::string& path) {
+    return adopt(openSegment(path, false));
+}
+
+std::unique_ptr<FileTape> FileTape::open(const std::string& path, size_t start, size_t size) {
+    return adopt(openSegment(path, start, size));
+}
+
+std::unique_ptr<FileTape> FileTape::fromData(const std::string& data) {
+    std::string path = workingPath(".tape");
+    if (path.empty()) return nullptr;
+    {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        os.write(data.data(), static_cast<std::streamsize>(data.length()));
+        if (!os.flush()) {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return nullptr;
+        }
+    }
+    auto segment = openSegment(path, true);
+    if (!segment) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return adopt(std::move(segment));
+}
+
+std::unique_ptr<FileTape> FileTape::fromTape(const TapeStorage& tape) {
+    std::string path = workingPath(".tape");
+    if (path.empty()) return nullptr;
+    {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        tape.forEachChunk(0, tape.size(), [&](const char* data, size_t n, size_t) {
+            return static_cast<bool>(os.write(data, static_cast<std::streamsize>(n)));
+        });
+        if (!os.flush()) {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return nullptr;
+        }
+    }
+    auto segment = openSegment(path, true);
+    if (!segment) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return adopt(std::move(segment));
+}
+
+std::unique_ptr<TapeStorage> FileTape::clone() const {
+    return std::unique_ptr<FileTape>(new FileTape(*this));
+}
+
+void FileTape::update(int t) {
+    Node& n = m_nodes[t];
+    n.size = sizeOf(n.left) + n.length + sizeOf(n.right);
+}
+
+int FileTape::newNode(const Piece& piece, uint32_t priority) {
+    int t;
+    if (!m_free.empty()) {
+        t = m_free.back();
+        m_free.pop_back();
+    } else {
+        t = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    Node& n = m_nodes[t];
+    n.segment = piece.segment;
+    n.offset = piece.offset;
+    n.length = piece.length;
+    n.priority = priority;
+    n.left = n.right = -1;
+    n.size = n.length;
+    ++m_pieces;
+    return t;
+}
+
+int FileTape::newNode(const Piece& piece) {
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return newNode(piece, m_seed);
+}
+
+void FileTape::release(int t) {
+    if (t < 0) return;
+    release(m_nodes[t].left);
+    release(m_nodes[t].right);
+    m_free.push_back(t);
+    --m_pieces;
+}
+
+// Splits t into a (first k symbols) and b (the rest), cutting a piece in two
+// when k falls inside it.
+void FileTape::split(int t, size_t k, int& a, int& b) {
+    if (t < 0) {
+        a = b = -1;
+        return;
+    }
+    size_t leftSize = sizeOf(m_nodes[t].left);
+    size_t ownSize = m_nodes[t].length;
+    // Children are written back after the recursion: newNode() may grow m_nodes.
+    if (k <= leftSize) {
+        int rest;
+        split(m_nodes[t].left, k, a, rest);
+        m_nodes[t].left = rest;
+        update(t);
+        b = t;
+    } else if (k >= leftSize + ownSize) {
+        int rest;
+        split(m_nodes[t].right, k - leftSize - ownSize, rest, b);
+        m_nodes[t].right = rest;
+        update(t);
+        a = t;
+    } else {
+        size_t cut = k - leftSize;
+        const Node& n = m_nodes[t];
+        // The tail piece inherits the priority, so it may take over the right subtree.
+        int tail = newNode({n.segment, n.offset + cut, n.length - cut}, n.priority);
+        m_nodes[t].length = cut;
+        m_nodes[tail].right = m_nodes[t].right;
+        m_nodes[t].right = -1;
+        update(tail);
+        update(t);
+        a = t;
+        b = tail;
+    }
+}
+
+int FileTape::merge(int a, int b) {
+    if (a < 0) return b;
+    if (b < 0) return a;
+    if (m_nodes[a].priority >= m_nodes[b].priority) {
+        int r = merge(m_nodes[a].right, b);
+        m_nodes[a].right = r;
+        update(a);
+        return a;
+    }
+    int l = merge(a, m_nodes[b].left);
+    m_nodes[b].left = l;
+    update(b);
+    return b;
+}
+
+const char* FileTape::pieceData(const Node& n) const {
+    return (n.segment < 0 ? m_added.data() : m_segments[n.segment]->data()) + n.offset;
+}
+
+void FileTape::collect(int t, std::vector<Piece>& out) const {
+    if (t < 0) return;
+    collect(m_nodes[t].left, out);
+    out.push_back({m_nodes[t].segment, m_nodes[t].offset, m_nodes[t].length});
+    collect(m_nodes[t].right, out);
+}
+
+char FileTape::at(size_t i) const {
+    int t = m_root;
+    while (t >= 0) {
+        const Node& n = m_nodes[t];
+        size_t leftSize = sizeOf(n.left);
+        if (i < leftSize) {
+            t = n.left;
+        } else if (i < leftSize + n.length) {
+            return pieceData(n)[i - leftSize];
+        } else {
+            i -= leftSize + n.length;
+            t = n.right;
+        }
+    }
+    return '\0';
+}
+
+void FileTape::replace(size_t pos, size_t len, const std::string& text) {
+    int a, rest, b, c;
+    split(m_root, pos, a, rest);
+    split(rest, len, b, c);
+    release(b);
+    if (!text.empty()) {
+        a = merge(a, newNode({-1, m_added.length(), text.length()}));
+        m_added += text;
+    }
+    m_root = merge(a, c);
+    if (m_pieces > m_compactAt) compact();
+}
+
+// Writes every run of adjacent dirty pieces (inserted text, or shorter than
+// kSmallPiece) that holds inserted text or more than one piece to a new
+// spill file, and rebuilds the table with one piece per run. Files no piece
+// refers to any more are dropped from m_segments and, once no clone uses
+// them either, deleted. If the spill file cannot be written the table is
+// left as it is and compaction is retried after it has doubled.
+void FileTape::compact() {
+    std::vector<Piece> pieces;
+    pieces.reserve(m_pieces);
+    collect(m_root, pieces);
+    m_compactAt = std::max(kCompactAfterPieces, 2 * m_pieces);
+
+    auto dirty = [](const Piece& p) { return p.segment < 0 || p.length < kSmallPiece; };
+    std::vector<std::pair<size_t, size_t>> runs;
+    for (size_t i = 0; i < pieces.size();) {
+        if (!dirty(pieces[i])) {
+            ++i;
+            continue;
+        }
+        size_t j = i;
+        bool inserted = false;
+        for (; j < pieces.size() && dirty(pieces[j]); ++j) inserted |= pieces[j].segment < 0;
+        if (inserted || j - i > 1) runs.push_back({i, j});
+        i = j;
+    }
+    if (runs.empty()) return;
+
+    std::string target = workingPath(".spill");
+    if (target.empty()) return;
+    {
+        std::ofstream os(target, std::ios::binary | std::ios::trunc);
+        for (auto [begin, end] : runs) {
+            for (size_t k = begin; k < end; ++k) {
+                const Piece& p = pieces[k];
+                const char* data = (p.segment < 0 ? m_added.data() : m_segments[p.segment]->data()) + p.offset;
+                os.write(data, static_cast<std::streamsize>(p.length));
+            }
+        }
+        if (!os.flush()) {
+            std::error_code ec;
+            std::filesystem::remove(target, ec);
+            return;
+        }
+    }
+    std::shared_ptr<const Segment> spill = openSegment(target, true);
+    if (!spill) {
+        std::error_code ec;
+        std::filesystem::remove(target, ec);
+        return;
+    }
+
+    std::vector<std::shared_ptr<const Segment>> segments{spill};
+    std::vector<int> renumbered(m_segments.size(), -1);
+    std::vector<Piece> compacted;
+    size_t spillOffset = 0;
+    size_t run = 0;
+    for (size_t i = 0; i < pieces.size();) {
+        if (run < runs.size() && runs[run].first == i) {
+            size_t length = 0;
+            for (size_t k = runs[run].first; k < runs[run].second; ++k) length += pieces[k].length;
+            compacted.push_back({0, spillOffset, length});
+            spillOffset += length;
+            i = runs[run++].second;
+            continue;
+        }
+        Piece p = pieces[i++];
+        if (renumbered[p.segment] < 0) {
+            renumbered[p.segment] = static_cast<int>(segments.size());
+            segments.push_back(m_segments[p.segment]);
+        }
+        p.segment = renumbered[p.segment];
+        compacted.push_back(p);
+    }
+
+    m_nodes.clear();
+    m_free.clear();
+    m_pieces = 0;
+    m_root = -1;
+    for (const Piece& p : compacted) m_root = merge(m_root, newNode(p));
+    m_segments = std::move(segments);
+    m_added.clear();
+    m_added.shrink_to_fit();
+    m_compactAt = std::max(kCompactAfterPieces, 2 * m_pieces);
+}
+
+void FileTape::forEachChunk(size_t from, size_t to, const ChunkFn& fn) const {
+    to = std::min(to, size());
+    // In-order walk that skips subtrees outside [from, to).
+    std::vector<std::pair<int, size_t>> stack;  // node, offset of its subtree
+    int t = m_root;
+    size_t base = 0;
+    while (from < to && (t >= 0 || !stack.empty())) {
+        while (t >= 0) {
+            const Node& n = m_nodes[t];
+            size_t own = base + sizeOf(n.left);
+            if (own + n.length <= from) {
+                base = own + n.length;
+                t = n.right;
+            } else if (own >= to) {
+                t = n.left;
+            } else {
+                stack.push_back({t, base});
+                t = n.left;
+            }
+        }
+        if (stack.empty()) break;
+        auto [node, nodeBase] = stack.back();
+        stack.pop_back();
+        const Node& n = m_nodes[node];
+        size_t own = nodeBase + sizeOf(n.left);
+        size_t lo = std::max(from, own);
+        size_t hi = std::min(to, own + n.length);
+        if (lo < hi && !fn(pieceData(n) + (lo - own), hi - lo, lo)) return;
+        from = std::max(from, hi);
+        base = own + n.length;
+        t = n.right;
+    }
+}
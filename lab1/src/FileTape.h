@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "MappedFile.h"
+#include "TapeStorage.h"
+
+// Tape that lives in files instead of RAM. The tape file is memory-mapped
+// and never modified; rewrites go to a piece table, kept as an implicit
+// treap keyed by tape offset, over the mapped files plus a buffer of
+// inserted text. Once the table grows long, runs of edited or short pieces
+// (the dirty regions) are written to a new spill file and replaced by one
+// piece each, so compaction costs the size of the dirty regions rather than
+// of the tape, and the inserted-text buffer is emptied. Working and spill
+// files go to the temporary directory, never next to an opened input.
+class FileTape : public TapeStorage {
+    struct Segment {
+        MappedFile map;
+        std::string path;
+        size_t start = 0;  // the tape is map[start, start + size)
+        size_t size = 0;
+        bool owned = false;  // a spill or working file: removed with the last reference
+        const char* data() const { return map.data() + start; }
+        ~Segment();
+    };
+
+    struct Node {
+        int segment = -1;  // index into m_segments, -1 for m_added
+        size_t offset = 0;
+        size_t length = 0;
+        uint32_t priority = 0;
+        int left = -1;
+        int right = -1;
+        size_t size = 0;  // symbols in the whole subtree
+    };
+
+    struct Piece {
+        int segment;
+        size_t offset;
+        size_t length;
+    };
+
+    std::vector<std::shared_ptr<const Segment>> m_segments;
+    std::vector<Node> m_nodes;
+    std::vector<int> m_free;
+    int m_root = -1;
+    size_t m_pieces = 0;
+    size_t m_compactAt = kCompactAfterPieces;
+    uint32_t m_seed = 0x9E3779B9u;
+    std::string m_added;
+
+    FileTape() = default;
+    static std::shared_ptr<const Segment> openSegment(const std::string& path, bool owned);
+    static std::shared_ptr<const Segment> openSegment(const std::string& path, size_t start, size_t size);
+    static std::unique_ptr<FileTape> adopt(std::shared_ptr<const Segment> segment);
+
+    size_t sizeOf(int t) const { return t < 0 ? 0 : m_nodes[t].size; }
+    void update(int t);
+    int newNode(const Piece& piece, uint32_t priority);
+    int newNode(const Piece& piece);
+    void release(int t);
+    void split(int t, size_t k, int& a, int& b);
+    int merge(int a, int b);
+    const char* pieceData(const Node& n) const;
+    void collect(int t, std::vector<Piece>& out) const;
+    void compact();
+
+public:
+    static constexpr size_t kCompactAfterPieces = 1024;
+    // Pieces shorter than this are rewritten by compaction with their
+    // neighbours; longer ones stay references into their file.
+    static constexpr size_t kSmallPiece = 64 * 1024;
+
+    // Maps an existing file; nullptr if it cannot be opened.
+    static std::unique_ptr<FileTape> open(const std::string& path);
+    // Maps the bytes [start, start + size) of a file, e.g. the tape section
+    // of a checkpoint; nullptr if the file is shorter.
+    static std::unique_ptr<FileTape> open(const std::string& path, size_t start, size_t size);
+    // Writes data to a temporary working file and maps that.
+    static std::unique_ptr<FileTape> fromData(const std::string& data);
+    // Same, streaming the chunks of another tape instead of copying it whole.
+    static std::unique_ptr<FileTape> fromTape(const TapeStorage& tape);
+
+    std::unique_ptr<TapeStorage> clone() const override;
+    size_t size() const override { return sizeOf(m_root); }
+    char at(size_t i) const override;
+    void replace(size_t pos, size_t len, const std::string& text) override;
+    void forEachChunk(size_t from, size_t to, const ChunkFn& fn) const override;
+
+    size_t pieceCount() const { return m_pieces; }
+    size_t fileCount() const { return m_segments.size(); }
+};
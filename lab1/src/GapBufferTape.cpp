@@ -0,0 +1,62 @@
+#include "GapBufferTape.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const size_t kMinGap = 64;
+}
+
+GapBufferTape::GapBufferTape(const std::string& data)
+    : m_buf(data.begin(), data.end()), m_gapBegin(data.length()), m_gapEnd(data.length()) {
+    reserveGap(kMinGap);
+}
+
+std::unique_ptr<TapeStorage> GapBufferTape::clone() const {
+    return std::make_unique<GapBufferTape>(*this);
+}
+
+void GapBufferTape::moveGap(size_t pos) {
+    if (pos < m_gapBegin) {
+        size_t n = m_gapBegin - pos;
+        std::memmove(m_buf.data() + m_gapEnd - n, m_buf.data() + pos, n);
+        m_gapBegin -= n;
+        m_gapEnd -= n;
+    } else if (pos > m_gapBegin) {
+        size_t n = pos - m_gapBegin;
+        std::memmove(m_buf.data() + m_gapBegin, m_buf.data() + m_gapEnd, n);
+        m_gapBegin += n;
+        m_gapEnd += n;
+    }
+}
+
+void GapBufferTape::reserveGap(size_t n) {
+    if (gapLength() >= n) return;
+    size_t tail = m_buf.size() - m_gapEnd;
+    size_t grow = std::max(n - gapLength(), std::max(kMinGap, size()));
+    m_buf.resize(m_buf.size() + grow);
+    std::memmove(m_buf.data() + m_buf.size() - tail, m_buf.data() + m_gapEnd, tail);
+    m_gapEnd = m_buf.size() - tail;
+}
+
+void GapBufferTape::replace(size_t pos, size_t len, const std::string& text) {
+    if (len == text.length()) {
+        for (size_t i = 0; i < len; ++i)
+            m_buf[pos + i < m_gapBegin ? pos + i : pos + i + gapLength()] = text[i];
+        return;
+    }
+    moveGap(pos);
+    m_gapEnd += len;
+    reserveGap(text.length());
+    std::memcpy(m_buf.data() + m_gapBegin, text.data(), text.length());
+    m_gapBegin += text.length();
+}
+
+void GapBufferTape::forEachChunk(size_t from, size_t to, const ChunkFn& fn) const {
+    to = std::min(to, size());
+    if (from < std::min(to, m_gapBegin)) {
+        size_t end = std::min(to, m_gapBegin);
+        if (!fn(m_buf.data() + from, end - from, from)) return;
+        from = end;
+    }
+    if (from < to) fn(m_buf.data() + from + gapLength(), to - from, from);
+}
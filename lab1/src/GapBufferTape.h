@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include "TapeStorage.h"
+
+// Tape with a movable gap at the last edit: a rewrite costs its own length
+// plus the distance from the previous one, not the length of the tail.
+class GapBufferTape : public TapeStorage {
+    std::vector<char> m_buf;
+    size_t m_gapBegin = 0;
+    size_t m_gapEnd = 0;
+
+    size_t gapLength() const { return m_gapEnd - m_gapBegin; }
+    void moveGap(size_t pos);
+    void reserveGap(size_t n);
+
+public:
+    explicit GapBufferTape(const std::string& data);
+
+    std::unique_ptr<TapeStorage> clone() const override;
+    size_t size() const override { return m_buf.size() - gapLength(); }
+    char at(size_t i) const override { return m_buf[i < m_gapBegin ? i : i + gapLength()]; }
+    void replace(size_t pos, size_t len, const std::string& text) override;
+    void forEachChunk(size_t from, size_t to, const ChunkFn& fn) const override;
+};
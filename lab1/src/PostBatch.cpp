@@ -0,0 +1,29 @@
+#include "PostBatch.h"
+#include <algorithm>
+
+PostBatch::PostBatch(std::shared_ptr<const RuleMatcher> rules, TapeBackend backend)
+    : m_rules(std::move(rules)), m_backend(backend) {}
+
+PostBatch::PostBatch(PostMachine& prototype)
+    : m_rules(prototype.compiledRules()), m_backend(prototype.backend()) {}
+
+std::vector<BatchResult> PostBatch::run(const std::vector<BatchJob>& jobs, ThreadPool& pool) const {
+    std::vector<BatchResult> results(jobs.size());
+    // Small slices keep every worker busy when tapes differ in run length;
+    // idle workers steal the slices still queued elsewhere.
+    size_t grain = std::max<size_t>(1, jobs.size() / (pool.size() * 16));
+    pool.parallelFor(jobs.size(), grain, [&](size_t begin, size_t end) {
+        PostMachine pm("_", m_rules, m_backend);
+        for (size_t i = begin; i < end; ++i) {
+            pm.reset(jobs[i].tape);
+            pm.run(jobs[i].maxSteps);
+            results[i] = {pm.tape(), pm.pos(), pm.steps()};
+        }
+    });
+    return results;
+}
+
+std::vector<BatchResult> PostBatch::run(const std::vector<BatchJob>& jobs, size_t threads) const {
+    ThreadPool pool(threads);
+    return run(jobs, pool);
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "PostMachine.h"
+#include "ThreadPool.h"
+
+struct BatchJob {
+    std::string tape;
+    int maxSteps = -1;
+};
+
+struct BatchResult {
+    std::string tape;
+    size_t pos = 0;
+    size_t steps = 0;
+};
+
+// Runs one compiled rule set over many tapes. Every worker steps its own
+// machine; the rules are shared read-only between them.
+class PostBatch {
+    std::shared_ptr<const RuleMatcher> m_rules;
+    TapeBackend m_backend;
+
+public:
+    explicit PostBatch(std::shared_ptr<const RuleMatcher> rules,
+                       TapeBackend backend = TapeBackend::String);
+    explicit PostBatch(PostMachine& prototype);
+
+    std::vector<BatchResult> run(const std::vector<BatchJob>& jobs, ThreadPool& pool) const;
+    std::vector<BatchResult> run(const std::vector<BatchJob>& jobs, size_t threads = 0) const;
+};
@@ -0,0 +1,168 @@
+// Binary checkpoints of a PostMachine.
+//
+// Layout (native byte order, no padding):
+//   char[4]  magic "PMCK"
+//   uint32   version
+//   uint64   step counter
+//   uint64   head position
+//   uint8    tape backend
+//   uint64   rule count
+//   per rule: uint64 pattern length, uint64 replace length, uint8 moveRight,
+//             pattern bytes, replace bytes
+//   uint64   tape length
+//   tape bytes
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "FileTape.h"
+#include "MappedFile.h"
+#include "PostMachine.h"
+
+namespace {
+
+const char kMagic[4] = {'P', 'M', 'C', 'K'};
+const uint32_t kVersion = 1;
+
+template<class T>
+void put(std::ostream& os, T value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putString(std::ostream& os, const std::string& s) {
+    os.write(s.data(), static_cast<std::streamsize>(s.length()));
+}
+
+// Bounds-checked reader over the mapped checkpoint.
+class Reader {
+    const char* m_at;
+    const char* m_end;
+
+public:
+    Reader(const char* data, size_t size) : m_at(data), m_end(data + size) {}
+
+    bool ok = true;
+
+    template<class T>
+    T get() {
+        T value{};
+        if (static_cast<size_t>(m_end - m_at) < sizeof(T)) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, m_at, sizeof(T));
+        m_at += sizeof(T);
+        return value;
+    }
+
+    const char* bytes(uint64_t n) {
+        if (static_cast<uint64_t>(m_end - m_at) < n) {
+            ok = false;
+            return nullptr;
+        }
+        const char* p = m_at;
+        m_at += n;
+        return p;
+    }
+};
+
+}
+
+bool PostMachine::saveCheckpoint(const std::string& path) const {
+    // Written next to the target and renamed over it, so a crash while
+    // writing leaves the previous checkpoint intact.
+    std::string tmp = path + ".tmp";
+    std::error_code ec;
+    {
+        std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+        if (!os) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        os.write(kMagic, sizeof(kMagic));
+        put<uint32_t>(os, kVersion);
+        put<uint64_t>(os, m_steps);
+        put<uint64_t>(os, m_pos);
+        put<uint8_t>(os, static_cast<uint8_t>(m_backend));
+        put<uint64_t>(os, m_rules.size());
+        for (const Rule& rule : m_rules) {
+            put<uint64_t>(os, rule.pattern.length());
+            put<uint64_t>(os, rule.replace.length());
+            put<uint8_t>(os, rule.moveRight ? 1 : 0);
+            putString(os, rule.pattern);
+            putString(os, rule.replace);
+        }
+        put<uint64_t>(os, m_tape->size());
+        m_tape->forEachChunk(0, m_tape->size(), [&](const char* data, size_t n, size_t) {
+            return static_cast<bool>(os.write(data, static_cast<std::streamsize>(n)));
+        });
+        if (!os.flush()) {
+            os.close();
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::error_code ignored;
+        std::filesystem::remove(tmp, ignored);
+        return false;
+    }
+    return true;
+}
+
+bool PostMachine::loadCheckpoint(const std::string& path) {
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() < sizeof(kMagic)) return false;
+    if (std::memcmp(file.data(), kMagic, sizeof(kMagic)) != 0) return false;
+
+    Reader in(file.data() + sizeof(kMagic), file.size() - sizeof(kMagic));
+    if (in.get<uint32_t>() != kVersion) return false;
+    uint64_t steps = in.get<uint64_t>();
+    uint64_t pos = in.get<uint64_t>();
+    uint8_t backend = in.get<uint8_t>();
+    uint64_t ruleCount = in.get<uint64_t>();
+    if (!in.ok || backend > static_cast<uint8_t>(TapeBackend::File)) return false;
+
+    std::vector<Rule> rules;
+    for (uint64_t r = 0; r < ruleCount && in.ok; ++r) {
+        uint64_t patternLength = in.get<uint64_t>();
+        uint64_t replaceLength = in.get<uint64_t>();
+        bool moveRight = in.get<uint8_t>() != 0;
+        const char* pattern = in.bytes(patternLength);
+        const char* replace = in.bytes(replaceLength);
+        if (!in.ok || patternLength == 0) return false;
+        rules.push_back({std::string(pattern, patternLength),
+                         replaceLength ? std::string(replace, replaceLength) : std::string(), moveRight});
+    }
+    uint64_t tapeLength = in.get<uint64_t>();
+    const char* tape = in.bytes(tapeLength);
+    if (!in.ok || pos > tapeLength) return false;
+
+    std::unique_ptr<TapeStorage> loaded;
+    // The File backend keeps reading the tape from the checkpoint itself.
+    if (static_cast<TapeBackend>(backend) == TapeBackend::File)
+        loaded = FileTape::open(path, static_cast<size_t>(tape - file.data()), tapeLength);
+    if (!loaded) loaded = makeTape(static_cast<TapeBackend>(backend), tapeLength ? std::string(tape, tapeLength) : std::string());
+
+    m_backend = static_cast<TapeBackend>(backend);
+    m_tape = std::move(loaded);
+    m_viewValid = false;
+    m_rules = std::move(rules);
+    m_matcher.reset();
+    m_leftmostValid = false;
+    m_tapeHashValid = false;
+    m_pos = pos;
+    m_steps = steps;
+    return true;
+}
+
+bool PostMachine::runWithCheckpoints(int maxSteps, const std::string& path, size_t every) {
+    if (every == 0) every = 1;
+    int steps = 0;
+    while ((maxSteps < 0 || steps < maxSteps) && step()) {
+        ++steps;
+        if (m_steps % every == 0 && !saveCheckpoint(path)) return false;
+    }
+    return saveCheckpoint(path);
+}
@@ -1,42 +1,498 @@
 #include "PostMachine.h"
+#include "FileTape.h"
+#include "ThreadPool.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 
-PostMachine::PostMachine(const std::string& tape)
-    : m_tape(tape.empty() ? "_" : tape) {}
+namespace {
+
+const uint64_t kHashModulus = (uint64_t(1) << 61) - 1;
+
+uint64_t addMod(uint64_t a, uint64_t b) {
+    uint64_t s = a + b;
+    return s >= kHashModulus ? s - kHashModulus : s;
+}
+
+uint64_t subMod(uint64_t a, uint64_t b) {
+    return a >= b ? a - b : a + kHashModulus - b;
+}
+
+// a * b mod 2^61 - 1 for a, b < 2^61, from 32-bit halves (2^61 = 1).
+uint64_t mulMod(uint64_t a, uint64_t b) {
+    uint64_t a1 = a >> 32, a0 = a & 0xFFFFFFFFu;
+    uint64_t b1 = b >> 32, b0 = b & 0xFFFFFFFFu;
+    uint64_t mid = a1 * b0 + a0 * b1;
+    uint64_t low = a0 * b0;
+    uint64_t s = (a1 * b1 << 3) + (mid >> 29) + ((mid & ((uint64_t(1) << 29) - 1)) << 32) +
+                 (low & kHashModulus) + (low >> 61);
+    s = (s & kHashModulus) + (s >> 61);
+    return s >= kHashModulus ? s - kHashModulus : s;
+}
+
+uint64_t powMod(uint64_t base, uint64_t exponent) {
+    uint64_t result = 1;
+    for (; exponent; exponent >>= 1, base = mulMod(base, base))
+        if (exponent & 1) result = mulMod(result, base);
+    return result;
+}
+
+const uint64_t kHashBase = 0x1F3D5B79A3C2E1ull % kHashModulus;
+const uint64_t kHashBaseInverse = powMod(kHashBase, kHashModulus - 2);
+
+// Per-symbol values (splitmix64 of the byte, reduced).
+const std::array<uint64_t, 256> kSymbolMix = [] {
+    std::array<uint64_t, 256> mix{};
+    for (size_t c = 0; c < mix.size(); ++c) {
+        uint64_t z = c + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        mix[c] = (z ^ (z >> 31)) % kHashModulus;
+    }
+    return mix;
+}();
+
+// Adds the terms of tape[from, to) to sum, power being base^from on entry
+// and base^to on return.
+void hashRange(const TapeStorage& tape, size_t from, size_t to, uint64_t& sum, uint64_t& power) {
+    tape.forEachChunk(from, to, [&](const char* data, size_t n, size_t) {
+        for (size_t i = 0; i < n; ++i) {
+            sum = addMod(sum, mulMod(kSymbolMix[static_cast<unsigned char>(data[i])], power));
+            power = mulMod(power, kHashBase);
+        }
+        return true;
+    });
+}
+
+uint64_t textHash(const std::string& text) {
+    uint64_t sum = 0, power = 1;
+    for (unsigned char c : text) {
+        sum = addMod(sum, mulMod(kSymbolMix[c], power));
+        power = mulMod(power, kHashBase);
+    }
+    return sum;
+}
+
+}
+
+PostMachine::PostMachine(const std::string& tape, TapeBackend backend)
+    : m_backend(backend), m_tape(makeTape(backend, tape.empty() ? "_" : tape)) {}
+
+PostMachine::PostMachine(const std::string& tape, std::shared_ptr<const RuleMatcher> rules,
+                         TapeBackend backend)
+    : m_backend(backend), m_tape(makeTape(backend, tape.empty() ? "_" : tape)),
+      m_rules(rules->rules()), m_matcher(std::move(rules)) {}
+
+PostMachine::PostMachine(const PostMachine& other)
+    : m_backend(other.m_backend), m_tape(other.m_tape->clone()), m_pos(other.m_pos),
+      m_steps(other.m_steps), m_rules(other.m_rules), m_matcher(other.m_matcher),
+      m_leftmost(other.m_leftmost), m_leftmostValid(other.m_leftmostValid),
+      m_symbolCounts(other.m_symbolCounts), m_present(other.m_present),
+      m_tapeHash(other.m_tapeHash), m_hashPrefix(other.m_hashPrefix), m_cursorPower(other.m_cursorPower),
+      m_hashCursor(other.m_hashCursor), m_tapeHashValid(other.m_tapeHashValid),
+      m_pool(other.m_pool), m_parallelThreshold(other.m_parallelThreshold) {}
+
+PostMachine& PostMachine::operator=(const PostMachine& other) {
+    if (this != &other) *this = PostMachine(other);
+    return *this;
+}
+
+void PostMachine::setBackend(TapeBackend backend) {
+    if (backend == m_backend) return;
+    std::unique_ptr<TapeStorage> tape;
+    // Stream into the working file rather than materializing the tape first.
+    if (backend == TapeBackend::File) tape = FileTape::fromTape(*m_tape);
+    m_tape = tape ? std::move(tape) : makeTape(backend, m_tape->str());
+    m_backend = backend;
+    m_viewValid = false;
+}
+
+void PostMachine::setParallelSearch(ThreadPool* pool, size_t threshold) {
+    m_pool = pool;
+    m_parallelThreshold = threshold;
+}
+
+bool PostMachine::searchInParallel(size_t length) const {
+    return m_pool && length >= m_parallelThreshold && !m_tape->compressed();
+}
+
+// A few chunks per thread so that a slow chunk does not hold up the rest.
+size_t PostMachine::chunkLength(size_t length) const {
+    const size_t minChunk = 4096;
+    size_t parts = 4 * (m_pool->size() + 1);
+    return std::max(minChunk, (length + parts - 1) / parts);
+}
+
+// Full automaton scan of the tape, one scan per chunk starting from the root
+// state. Each chunk reads maxLength - 1 symbols past its end, so every
+// occurrence starting inside it is seen; m_leftmost takes the minimum over
+// the chunks. Returns the number of symbols scanned.
+size_t PostMachine::scanParallel(size_t missing) {
+    size_t size = m_tape->size();
+    size_t reach = m_matcher->maxLength() - 1;
+    size_t chunk = chunkLength(size);
+    size_t parts = (size + chunk - 1) / chunk;
+    std::vector<std::vector<size_t>> found(parts);
+    std::atomic<size_t> scanned{0};
+
+    m_pool->parallelFor(parts, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            std::vector<size_t>& local = found[i];
+            local.assign(m_rules.size(), RuleMatcher::npos);
+            size_t left = missing;
+            size_t lo = i * chunk;
+            size_t hi = std::min(size, lo + chunk + reach);
+            uint32_t state = 0;
+            m_tape->forEachChunk(lo, hi, [&](const char* data, size_t n, size_t offset) {
+                state = m_matcher->scan(state, data, n, offset, local, left);
+                scanned += n;
+                return left > 0;
+            });
+        }
+    });
+    for (const std::vector<size_t>& local : found)
+        for (size_t r = 0; r < m_rules.size(); ++r)
+            m_leftmost[r] = std::min(m_leftmost[r], local[r]);
+    return scanned;
+}
+
+// Leftmost occurrence of pattern at or after from, searching chunks of
+// [from, size) concurrently. Chunks that start past a hit already found
+// are skipped.
+size_t PostMachine::findParallel(const std::string& pattern, size_t from) const {
+    size_t size = m_tape->size();
+    size_t chunk = chunkLength(size - from);
+    size_t parts = (size - from + chunk - 1) / chunk;
+    std::atomic<size_t> best{RuleMatcher::npos};
+
+    m_pool->parallelFor(parts, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t lo = from + i * chunk;
+            if (lo >= best.load(std::memory_order_relaxed)) return;
+            size_t hit = m_tape->findIn(pattern, lo, std::min(size, lo + chunk));
+            size_t current = best.load(std::memory_order_relaxed);
+            while (hit < current && !best.compare_exchange_weak(current, hit, std::memory_order_relaxed)) {}
+        }
+    });
+    return best;
+}
+
+bool PostMachine::openTapeFile(const std::string& path) {
+    std::unique_ptr<TapeStorage> tape = FileTape::open(path);
+    if (!tape) return false;
+    m_tape = std::move(tape);
+    m_backend = TapeBackend::File;
+    m_viewValid = false;
+    m_pos = 0;
+    m_steps = 0;
+    m_leftmostValid = false;
+    m_tapeHashValid = false;
+    return true;
+}
+
+const std::string& PostMachine::tape() const {
+    if (const std::string* data = m_tape->contiguous()) return *data;
+    if (!m_viewValid) {
+        m_view = m_tape->str();
+        m_viewValid = true;
+    }
+    return m_view;
+}
 
 void PostMachine::addRule(const std::string& pattern, const std::string& replace, bool moveRight) {
     if (pattern.empty()) return;
     m_rules.push_back({pattern, replace, moveRight});
+    m_matcher.reset();
 }
 
 void PostMachine::removeRule(size_t index) {
     if (index < m_rules.size())
         m_rules.erase(m_rules.begin() + index);
+    m_matcher.reset();
 }
 
-bool PostMachine::step() {
-    for (const auto& rule : m_rules) {
-        size_t pos = m_tape.find(rule.pattern);
-        if (pos != std::string::npos) {
-            m_tape.replace(pos, rule.pattern.length(), rule.replace);
-            m_pos = rule.moveRight ? (pos + rule.replace.length()) : pos;
-            if (m_pos > m_tape.length()) m_pos = m_tape.length();
-            return true;
+std::shared_ptr<const RuleMatcher> PostMachine::compiledRules() {
+    if (!m_matcher) {
+        m_matcher = std::make_shared<const RuleMatcher>(m_rules);
+        m_leftmostValid = false;
+    }
+    return m_matcher;
+}
+
+void PostMachine::reset(const std::string& tape) {
+    m_tape = makeTape(m_backend, tape.empty() ? "_" : tape);
+    m_viewValid = false;
+    m_pos = 0;
+    m_steps = 0;
+    m_leftmostValid = false;
+    m_tapeHashValid = false;
+}
+
+template<class Profiler>
+void PostMachine::rescanAll(Profiler& profiler) {
+    m_leftmost.assign(m_rules.size(), RuleMatcher::npos);
+    m_symbolCounts.fill(0);
+    m_tape->countSymbols(m_symbolCounts);
+    for (size_t c = 0; c < m_symbolCounts.size(); ++c) m_present[c] = m_symbolCounts[c] > 0;
+
+    if (m_tape->compressed()) {
+        for (size_t r = 0; r < m_rules.size(); ++r)
+            if (canMatch(r)) m_leftmost[r] = findFrom(r, 0, profiler);
+        m_leftmostValid = true;
+        return;
+    }
+    auto start = profiler.now();
+    size_t missing = 0;
+    for (size_t r = 0; r < m_rules.size(); ++r)
+        if (canMatch(r)) ++missing;
+    size_t scanned = 0;
+    if (missing > 0 && searchInParallel(m_tape->size())) {
+        scanned = scanParallel(missing);
+    } else {
+        uint32_t state = 0;
+        m_tape->forEachChunk(0, m_tape->size(), [&](const char* data, size_t n, size_t offset) {
+            state = m_matcher->scan(state, data, n, offset, m_leftmost, missing);
+            scanned += n;
+            return missing > 0;
+        });
+    }
+    profiler.onSharedScan(scanned, start);
+    // The pass ran for every rule that could match, up to its match or to
+    // the end of what was scanned.
+    for (size_t r = 0; r < m_rules.size(); ++r) {
+        if (m_leftmost[r] != RuleMatcher::npos)
+            profiler.onSharedMatch(r, m_leftmost[r] + m_matcher->length(r));
+        else if (canMatch(r))
+            profiler.onSharedMatch(r, scanned);
+    }
+    m_leftmostValid = true;
+}
+
+void PostMachine::countRewrite(const std::string& removed, const std::string& inserted) {
+    for (unsigned char c : removed)
+        if (--m_symbolCounts[c] == 0) m_present.reset(c);
+    for (unsigned char c : inserted)
+        if (m_symbolCounts[c]++ == 0) m_present.set(c);
+}
+
+template<class Profiler>
+size_t PostMachine::findFrom(size_t rule, size_t from, Profiler& profiler) {
+    auto start = profiler.now();
+    const std::string& pattern = m_rules[rule].pattern;
+    size_t found = from < m_tape->size() && searchInParallel(m_tape->size() - from)
+        ? findParallel(pattern, from) : m_tape->find(pattern, from);
+    size_t end = found == RuleMatcher::npos ? m_tape->size() : found + m_matcher->length(rule);
+    profiler.onRuleSearch(rule, end > from ? end - from : 0, start);
+    return found;
+}
+
+// Updates m_leftmost after m_tape[pos, pos + removed) was replaced by
+// `inserted` symbols. Occurrences entirely before the edit are untouched and
+// those entirely after it only shift, so just the window that can hold an
+// occurrence overlapping the edit is rescanned.
+template<class Profiler>
+void PostMachine::rescanAround(size_t pos, size_t removed, size_t inserted, Profiler& profiler) {
+    const size_t npos = RuleMatcher::npos;
+    size_t reach = m_matcher->maxLength() - 1;
+    size_t winStart = pos > reach ? pos - reach : 0;
+    size_t winEnd = std::min(m_tape->size(), pos + inserted + reach);
+
+    auto start = profiler.now();
+    m_windowText = m_tape->copy(winStart, winEnd - winStart);
+    m_window.assign(m_rules.size(), npos);
+    size_t missing = m_rules.size();
+    m_matcher->scan(0, m_windowText.data(), m_windowText.length(), winStart, m_window, missing);
+    profiler.onSharedScan(m_windowText.length(), start);
+
+    for (size_t r = 0; r < m_rules.size(); ++r) {
+        size_t& found = m_leftmost[r];
+        size_t len = m_matcher->length(r);
+        if (found != npos && found + len <= pos) continue;
+        if (!canMatch(r)) {
+            found = npos;
+            continue;
+        }
+        if (m_window[r] != npos) {
+            found = m_window[r];
+            profiler.onSharedMatch(r, found + len - winStart);
+        } else if (found == npos) {
+            continue;
+        } else if (found >= pos + removed) {
+            found = found - removed + inserted;
+        } else {
+            // The old occurrence was destroyed and nothing replaced it inside
+            // the window: resume the search where the window stopped.
+            size_t from = winEnd + 1 > len ? winEnd + 1 - len : 0;
+            found = findFrom(r, from, profiler);
         }
     }
-    return false;
 }
 
-void PostMachine::run(int maxSteps) {
+template<class Profiler>
+bool PostMachine::stepImpl(Profiler& profiler) {
+    auto start = profiler.now();
+    profiler.onStepStart(m_rules.size(), m_tape->size());
+    compiledRules();
+    if (!m_leftmostValid) rescanAll(profiler);
+
+    size_t index = 0;
+    while (index < m_rules.size() && m_leftmost[index] == RuleMatcher::npos) ++index;
+    if (index == m_rules.size()) return false;
+
+    const Rule& rule = m_rules[index];
+    size_t pos = m_leftmost[index];
+    if (m_tapeHashValid) rehashRewrite(pos, rule.pattern, rule.replace);
+    auto applied = profiler.now();
+    m_tape->replace(pos, rule.pattern.length(), rule.replace);
+    profiler.onHit(index, applied);
+    m_viewValid = false;
+    countRewrite(rule.pattern, rule.replace);
+    rescanAround(pos, rule.pattern.length(), rule.replace.length(), profiler);
+    m_pos = rule.moveRight ? (pos + rule.replace.length()) : pos;
+    if (m_pos > m_tape->size()) m_pos = m_tape->size();
+    ++m_steps;
+    profiler.onStep(m_tape->size(), start);
+    return true;
+}
+
+template<class Profiler>
+void PostMachine::runImpl(int maxSteps, Profiler& profiler) {
     int steps = 0;
-    while ((maxSteps < 0 || steps < maxSteps) && step())
+    while ((maxSteps < 0 || steps < maxSteps) && stepImpl(profiler))
         ++steps;
 }
 
+bool PostMachine::step() {
+    NullProfiler profiler;
+    return stepImpl(profiler);
+}
+
+bool PostMachine::step(RuleProfiler& profiler) {
+    return stepImpl(profiler);
+}
+
+void PostMachine::run(int maxSteps) {
+    NullProfiler profiler;
+    runImpl(maxSteps, profiler);
+}
+
+void PostMachine::run(int maxSteps, RuleProfiler& profiler) {
+    runImpl(maxSteps, profiler);
+}
+
+// Called before tape[pos, pos + removed.length()) becomes `inserted`.
+void PostMachine::rehashRewrite(size_t pos, const std::string& removed, const std::string& inserted) {
+    if (pos < m_hashCursor && pos < m_hashCursor - pos) {
+        m_hashPrefix = 0;
+        m_cursorPower = 1;
+        m_hashCursor = 0;
+    }
+    if (pos < m_hashCursor) {
+        uint64_t removedSum = 0;
+        uint64_t power = mulMod(m_cursorPower, powMod(kHashBaseInverse, m_hashCursor - pos));
+        m_cursorPower = power;
+        hashRange(*m_tape, pos, m_hashCursor, removedSum, power);
+        m_hashPrefix = subMod(m_hashPrefix, removedSum);
+    } else {
+        hashRange(*m_tape, m_hashCursor, pos, m_hashPrefix, m_cursorPower);
+    }
+    m_hashCursor = pos;
+
+    uint64_t suffix = subMod(subMod(m_tapeHash, m_hashPrefix), mulMod(m_cursorPower, textHash(removed)));
+    suffix = inserted.length() >= removed.length()
+        ? mulMod(suffix, powMod(kHashBase, inserted.length() - removed.length()))
+        : mulMod(suffix, powMod(kHashBaseInverse, removed.length() - inserted.length()));
+    m_tapeHash = addMod(addMod(m_hashPrefix, mulMod(m_cursorPower, textHash(inserted))), suffix);
+}
+
+PostMachine::StateKey PostMachine::stateKey() {
+    if (!m_tapeHashValid) {
+        m_tapeHash = 0;
+        uint64_t power = 1;
+        hashRange(*m_tape, 0, m_tape->size(), m_tapeHash, power);
+        m_hashPrefix = 0;
+        m_cursorPower = 1;
+        m_hashCursor = 0;
+        m_tapeHashValid = true;
+    }
+    return {m_tape->size(), m_pos, m_tapeHash};
+}
+
+bool PostMachine::sameState(PostMachine& other) {
+    return stateKey() == other.stateKey() && tape() == other.tape();
+}
+
+// Brent's algorithm: the current state is compared with one saved state,
+// which is re-saved whenever the distance to it reaches the next power of
+// two. A cycle of length lambda starting after mu steps is seen within about
+// mu + 2 * lambda steps. The start mu is then found by replaying from the
+// initial state. Two extra tapes are live at any time: the initial and the
+// saved state while searching, the two replaying machines afterwards.
+// The incremental tape hash is only kept up while this runs, so later
+// step() calls do not pay for it.
+RunReport PostMachine::runDetectingCycles(int maxSteps) {
+    RunReport report;
+    bool wasHashing = m_tapeHashValid;
+    PostMachine start(*this);
+    PostMachine saved(*this);
+    size_t power = 1;
+    size_t lambda = 0;
+
+    while (true) {
+        if (maxSteps >= 0 && report.steps >= static_cast<size_t>(maxSteps)) {
+            report.status = RunStatus::StepLimit;
+            m_tapeHashValid = wasHashing;
+            return report;
+        }
+        if (!step()) {
+            report.status = RunStatus::Halted;
+            m_tapeHashValid = wasHashing;
+            return report;
+        }
+        ++report.steps;
+        ++lambda;
+        if (sameState(saved)) break;
+        if (lambda == power) {
+            saved.m_tape = m_tape->clone();
+            saved.m_viewValid = false;
+            saved.m_pos = m_pos;
+            saved.m_tapeHash = m_tapeHash;
+            saved.m_hashPrefix = m_hashPrefix;
+            saved.m_cursorPower = m_cursorPower;
+            saved.m_hashCursor = m_hashCursor;
+            saved.m_tapeHashValid = m_tapeHashValid;
+            power *= 2;
+            lambda = 0;
+        }
+    }
+
+    m_tapeHashValid = wasHashing;
+    saved = PostMachine();
+    PostMachine tortoise(start);
+    PostMachine hare(std::move(start));
+    for (size_t i = 0; i < lambda; ++i) hare.step();
+    size_t mu = 0;
+    while (!tortoise.sameState(hare)) {
+        tortoise.step();
+        hare.step();
+        ++mu;
+    }
+    report.status = RunStatus::Cycle;
+    report.cycleStart = mu;
+    report.cycleLength = lambda;
+    return report;
+}
+
 std::ostream& operator<<(std::ostream& os, const PostMachine& pm) {
-    os << pm.m_tape << " | " << pm.m_pos;
+    pm.m_tape->forEachChunk(0, pm.m_tape->size(), [&](const char* data, size_t n, size_t) {
+        os.write(data, static_cast<std::streamsize>(n));
+        return true;
+    });
+    os << " | " << pm.m_pos;
     return os;
 }
 std::istream& operator>>(std::istream& is, PostMachine& pm) {
-    return is >> pm.m_tape, pm.m_pos = 0, is;
+    std::string tape;
+    if (is >> tape) pm.reset(tape);
+    return is;
 }
@@ -1,34 +1,145 @@
 #pragma once
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <iostream>
-#include <Rule.h>
-class Rule {
-public:
-    std::string pattern;
-    std::string replace;
-    bool moveRight = true;
+#include "PostProfiler.h"
+#include "Rule.h"
+#include "RuleMatcher.h"
+#include "TapeStorage.h"
+
+class ThreadPool;
+
+enum class RunStatus { Halted, StepLimit, Cycle };
+
+// Outcome of PostMachine::runDetectingCycles(). For a cycle, the state after
+// cycleStart steps recurs every cycleLength steps (1 for a fixed point).
+struct RunReport {
+    RunStatus status = RunStatus::Halted;
+    size_t steps = 0;
+    size_t cycleStart = 0;
+    size_t cycleLength = 0;
 };
 
 class PostMachine {
-    std::string m_tape = "_";
+    TapeBackend m_backend = TapeBackend::String;
+    std::unique_ptr<TapeStorage> m_tape = makeTape(TapeBackend::String, "_");
+    mutable std::string m_view;  // tape() of non-contiguous backends, built on demand
+    mutable bool m_viewValid = false;
     size_t m_pos = 0;
+    size_t m_steps = 0;
     std::vector<Rule> m_rules;
+    std::shared_ptr<const RuleMatcher> m_matcher;  // null until the next step() compiles m_rules
+
+    // Leftmost occurrence of every rule on the tape (npos = none), kept up to
+    // date by rescanning only the window around each rewrite.
+    std::vector<size_t> m_leftmost;
+    std::vector<size_t> m_window;
+    std::string m_windowText;
+    bool m_leftmostValid = false;
+
+    // How often each symbol occurs on the tape; valid together with
+    // m_leftmost. A rule needing an absent symbol cannot match.
+    std::array<size_t, 256> m_symbolCounts{};
+    std::bitset<256> m_present;
+
+    bool canMatch(size_t rule) const { return (m_matcher->symbols(rule) & ~m_present).none(); }
+    void countRewrite(const std::string& removed, const std::string& inserted);
+
+    // Polynomial hash of the tape, sum of mix(tape[i]) * base^i modulo
+    // 2^61 - 1, updated per rewrite. With length and position it filters
+    // states before whole tapes are compared. m_hashPrefix is the sum over
+    // tape[0, m_hashCursor) and m_cursorPower is base^m_hashCursor; a rewrite
+    // moves the cursor to itself, reading the symbols in between (or from the
+    // start, if nearer), and shifts the part after it by one multiplication.
+    uint64_t m_tapeHash = 0;
+    uint64_t m_hashPrefix = 0;
+    uint64_t m_cursorPower = 1;
+    size_t m_hashCursor = 0;
+    bool m_tapeHashValid = false;
+
+    void rehashRewrite(size_t pos, const std::string& removed, const std::string& inserted);
+
+    struct StateKey {
+        size_t length;
+        size_t pos;
+        uint64_t tapeHash;
+        bool operator==(const StateKey& o) const {
+            return length == o.length && pos == o.pos && tapeHash == o.tapeHash;
+        }
+    };
+    // Searches over at least m_parallelThreshold symbols of an uncompressed
+    // tape are split into chunks that overlap by the pattern length - 1 and
+    // run on m_pool; the leftmost hit over all chunks wins.
+    ThreadPool* m_pool = nullptr;
+    size_t m_parallelThreshold = 0;
+
+    bool searchInParallel(size_t length) const;
+    size_t chunkLength(size_t length) const;
+    size_t scanParallel(size_t missing);
+    size_t findParallel(const std::string& pattern, size_t from) const;
+
+    StateKey stateKey();
+    bool sameState(PostMachine& other);
+
+    // Stepping is written once against a profiling policy (PostProfiler.h)
+    // and instantiated for NullProfiler and RuleProfiler in PostMachine.cpp.
+    template<class Profiler> void rescanAll(Profiler& profiler);
+    template<class Profiler>
+    void rescanAround(size_t pos, size_t removed, size_t inserted, Profiler& profiler);
+    template<class Profiler> size_t findFrom(size_t rule, size_t from, Profiler& profiler);
+    template<class Profiler> bool stepImpl(Profiler& profiler);
+    template<class Profiler> void runImpl(int maxSteps, Profiler& profiler);
 
 public:
     PostMachine() = default;
-    explicit PostMachine(const std::string& tape);
+    explicit PostMachine(const std::string& tape, TapeBackend backend = TapeBackend::String);
+    PostMachine(const std::string& tape, std::shared_ptr<const RuleMatcher> rules,
+                TapeBackend backend = TapeBackend::String);
+    PostMachine(const PostMachine& other);
+    PostMachine(PostMachine&&) noexcept = default;
+    PostMachine& operator=(const PostMachine& other);
+    PostMachine& operator=(PostMachine&&) noexcept = default;
+    ~PostMachine() = default;
+
+    TapeBackend backend() const { return m_backend; }
+    void setBackend(TapeBackend backend);
+    // Uses the file at path as the tape without loading it (TapeBackend::File).
+    bool openTapeFile(const std::string& path);
+
+    static constexpr size_t kDefaultParallelThreshold = size_t(1) << 20;
+    // Searches tapes of at least threshold symbols on pool; nullptr searches
+    // serially. The pool must outlive the machine or the next call.
+    void setParallelSearch(ThreadPool* pool, size_t threshold = kDefaultParallelThreshold);
 
     void addRule(const std::string& pattern, const std::string& replace, bool moveRight = true);
     void removeRule(size_t index);
     size_t ruleCount() const { return m_rules.size(); }
+    std::shared_ptr<const RuleMatcher> compiledRules();
 
     bool step();
+    bool step(RuleProfiler& profiler);
     PostMachine& operator++() { step(); return *this; }
     void run(int maxSteps = -1);
+    void run(int maxSteps, RuleProfiler& profiler);
+    RunReport runDetectingCycles(int maxSteps = -1);
+
+    // Binary snapshot of tape, position, rules and step counter
+    // (format in PostCheckpoint.cpp). Loading maps the file into memory; a
+    // File-backend tape keeps reading its symbols from the checkpoint.
+    bool saveCheckpoint(const std::string& path) const;
+    bool loadCheckpoint(const std::string& path);
+    // run() that saves a checkpoint every `every` steps and once at the end.
+    bool runWithCheckpoints(int maxSteps, const std::string& path, size_t every);
+    void reset(const std::string& tape);
 
-    const std::string& tape() const { return m_tape; }
+    const std::string& tape() const;
+    size_t tapeLength() const { return m_tape->size(); }
     size_t pos() const { return m_pos; }
+    size_t steps() const { return m_steps; }
 
     friend std::ostream& operator<<(std::ostream& os, const PostMachine& pm);
     friend std::istream& operator>>(std::istream& is, PostMachine& pm);
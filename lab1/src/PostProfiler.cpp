@@ -0,0 +1,86 @@
+#include "PostProfiler.h"
+
+namespace {
+uint64_t elapsed(RuleProfiler::Tick start) {
+    auto d = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+}
+
+RuleProfiler::RuleStats& RuleProfiler::stats(size_t rule) {
+    if (rule >= m_rules.size()) m_rules.resize(rule + 1);
+    return m_rules[rule];
+}
+
+void RuleProfiler::onStepStart(size_t ruleCount, size_t tapeLength) {
+    if (m_rules.size() < ruleCount) m_rules.resize(ruleCount);
+    if (tapeLength > m_tapeHighWater) m_tapeHighWater = tapeLength;
+}
+
+void RuleProfiler::onSharedScan(size_t bytes, Tick start) {
+    m_sharedBytes += bytes;
+    m_sharedNanoseconds += elapsed(start);
+}
+
+void RuleProfiler::onSharedMatch(size_t rule, size_t bytes) {
+    RuleStats& s = stats(rule);
+    ++s.attempts;
+    s.bytesScanned += bytes;
+}
+
+void RuleProfiler::onRuleSearch(size_t rule, size_t bytes, Tick start) {
+    RuleStats& s = stats(rule);
+    ++s.attempts;
+    s.bytesScanned += bytes;
+    s.nanoseconds += elapsed(start);
+}
+
+void RuleProfiler::onHit(size_t rule, Tick start) {
+    RuleStats& s = stats(rule);
+    ++s.hits;
+    s.nanoseconds += elapsed(start);
+}
+
+void RuleProfiler::onStep(size_t tapeLength, Tick start) {
+    ++m_steps;
+    m_stepNanoseconds += elapsed(start);
+    if (tapeLength > m_tapeHighWater) m_tapeHighWater = tapeLength;
+}
+
+double RuleProfiler::stepsPerSecond() const {
+    return m_stepNanoseconds ? m_steps / seconds() : 0.0;
+}
+
+void RuleProfiler::clear() {
+    *this = RuleProfiler();
+}
+
+void RuleProfiler::writeJson(std::ostream& os) const {
+    os << "{\"steps\":" << m_steps
+       << ",\"seconds\":" << seconds()
+       << ",\"stepsPerSecond\":" << stepsPerSecond()
+       << ",\"tapeHighWater\":" << m_tapeHighWater
+       << ",\"sharedBytesScanned\":" << m_sharedBytes
+       << ",\"sharedNanoseconds\":" << m_sharedNanoseconds
+       << ",\"rules\":[";
+    for (size_t r = 0; r < m_rules.size(); ++r) {
+        const RuleStats& s = m_rules[r];
+        os << (r ? "," : "") << "{\"rule\":" << r
+           << ",\"attempts\":" << s.attempts
+           << ",\"hits\":" << s.hits
+           << ",\"bytesScanned\":" << s.bytesScanned
+           << ",\"nanoseconds\":" << s.nanoseconds << "}";
+    }
+    os << "]}";
+}
+
+void RuleProfiler::writeCsv(std::ostream& os) const {
+    // Run-wide figures are repeated on every row so each row stands alone.
+    os << "rule,attempts,hits,bytes_scanned,nanoseconds,steps,steps_per_second,tape_high_water\n";
+    for (size_t r = 0; r < m_rules.size(); ++r) {
+        const RuleStats& s = m_rules[r];
+        os << r << ',' << s.attempts << ',' << s.hits << ','
+           << s.bytesScanned << ',' << s.nanoseconds << ','
+           << m_steps << ',' << stepsPerSecond() << ',' << m_tapeHighWater << '\n';
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Instrumentation policies for PostMachine::step(). The machine calls the
+// same hooks on either policy; NullProfiler's are empty and inline, so the
+// uninstrumented step() compiles to the plain code path.
+struct NullProfiler {
+    using Tick = int;
+    Tick now() const { return 0; }
+    void onStepStart(size_t, size_t) {}
+    void onSharedScan(size_t, Tick) {}
+    void onSharedMatch(size_t, size_t) {}
+    void onRuleSearch(size_t, size_t, Tick) {}
+    void onHit(size_t, Tick) {}
+    void onStep(size_t, Tick) {}
+};
+
+// Per-rule counters and timings gathered while stepping a PostMachine.
+class RuleProfiler {
+public:
+    using Tick = std::chrono::steady_clock::time_point;
+
+    struct RuleStats {
+        uint64_t attempts = 0;      // times the rule's leftmost match was re-established
+        uint64_t hits = 0;          // times the rule fired
+        // Symbols examined to establish the rule's match: by its own searches,
+        // and by the shared automaton passes up to where they resolved it.
+        uint64_t bytesScanned = 0;
+        // Time in the rule's own searches and in its rewrites; the shared
+        // passes are timed once, in sharedNanoseconds.
+        uint64_t nanoseconds = 0;
+    };
+
+    Tick now() const { return std::chrono::steady_clock::now(); }
+    // Before each step: every rule gets a row, even if it never fires, and
+    // the tape length before the first rewrite counts towards the high water.
+    void onStepStart(size_t ruleCount, size_t tapeLength);
+    void onSharedScan(size_t bytes, Tick start);
+    void onSharedMatch(size_t rule, size_t bytes);
+    void onRuleSearch(size_t rule, size_t bytes, Tick start);
+    void onHit(size_t rule, Tick start);
+    void onStep(size_t tapeLength, Tick start);
+
+    const std::vector<RuleStats>& rules() const { return m_rules; }
+    uint64_t steps() const { return m_steps; }
+    uint64_t sharedBytesScanned() const { return m_sharedBytes; }
+    uint64_t sharedNanoseconds() const { return m_sharedNanoseconds; }
+    size_t tapeHighWater() const { return m_tapeHighWater; }
+    double seconds() const { return m_stepNanoseconds * 1e-9; }
+    double stepsPerSecond() const;
+    void clear();
+
+    void writeJson(std::ostream& os) const;
+    void writeCsv(std::ostream& os) const;
+
+private:
+    std::vector<RuleStats> m_rules;
+    uint64_t m_steps = 0;
+    uint64_t m_sharedBytes = 0;     // automaton passes shared by all rules
+    uint64_t m_sharedNanoseconds = 0;
+    uint64_t m_stepNanoseconds = 0;
+    size_t m_tapeHighWater = 0;
+
+    RuleStats& stats(size_t rule);
+};
@@ -0,0 +1,266 @@
+#include "RTree.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <queue>
+#include <tuple>
+
+namespace {
+
+int64_t area(const Rect2D& r) {
+    return int64_t(r.width()) * r.height();
+}
+
+// Twice the centre, which orders boxes without rounding.
+int64_t centreX(const Rect2D& r) { return int64_t(r.left()) + r.right(); }
+int64_t centreY(const Rect2D& r) { return int64_t(r.top()) + r.bottom(); }
+
+}
+
+uint32_t RTree::newNode(bool leaf) {
+    uint32_t index;
+    if (!m_freeNodes.empty()) {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_nodes[index] = Node{};
+    } else {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    m_nodes[index].leaf = leaf;
+    return index;
+}
+
+const Rect2D& RTree::entryBox(const Node& node, uint32_t entry) const {
+    return node.leaf ? m_rects[entry] : m_nodes[entry].box;
+}
+
+void RTree::recomputeBox(uint32_t node) {
+    Node& n = m_nodes[node];
+    if (n.entries.empty()) {
+        n.box = Rect2D();
+        return;
+    }
+    Rect2D box = entryBox(n, n.entries[0]);
+    for (size_t k = 1; k < n.entries.size(); ++k) box += entryBox(n, n.entries[k]);
+    n.box = box;
+}
+
+void RTree::build(const std::vector<Rect2D>& rects) {
+    m_rects = rects;
+    m_live.assign(rects.size(), true);
+    m_size = rects.size();
+    m_nodes.clear();
+    m_freeNodes.clear();
+
+    std::vector<uint32_t> level(rects.size());
+    std::iota(level.begin(), level.end(), 0);
+    if (level.empty()) {
+        m_root = newNode(true);
+        return;
+    }
+    bool leaf = true;
+    do {
+        level = pack(std::move(level), leaf);
+        leaf = false;
+    } while (level.size() > 1);
+    m_root = level[0];
+}
+
+// One STR level: sort by centre x, cut into about sqrt(nodes) vertical
+// slices, sort each slice by centre y and fill nodes of kMaxEntries in turn.
+std::vector<uint32_t> RTree::pack(std::vector<uint32_t> items, bool leaf) {
+    auto boxOf = [&](uint32_t item) -> const Rect2D& { return leaf ? m_rects[item] : m_nodes[item].box; };
+    size_t nodes = (items.size() + kMaxEntries - 1) / kMaxEntries;
+    size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodes))));
+    size_t sliceSize = slices * kMaxEntries;
+
+    std::sort(items.begin(), items.end(), [&](uint32_t a, uint32_t b) {
+        return centreX(boxOf(a)) < centreX(boxOf(b));
+    });
+    std::vector<uint32_t> parents;
+    for (size_t s = 0; s < items.size(); s += sliceSize) {
+        auto first = items.begin() + s;
+        auto last = items.begin() + std::min(items.size(), s + sliceSize);
+        std::sort(first, last, [&](uint32_t a, uint32_t b) {
+            return centreY(boxOf(a)) < centreY(boxOf(b));
+        });
+        for (auto it = first; it < last; it += std::min<ptrdiff_t>(kMaxEntries, last - it)) {
+            uint32_t node = newNode(leaf);
+            m_nodes[node].entries.assign(it, it + std::min<ptrdiff_t>(kMaxEntries, last - it));
+            recomputeBox(node);
+            parents.push_back(node);
+        }
+    }
+    return parents;
+}
+
+// Moves the upper half of an overfull node, along the axis where the entry
+// centres spread most, into a new sibling and returns it.
+uint32_t RTree::split(uint32_t node) {
+    uint32_t sibling = newNode(m_nodes[node].leaf);
+    Node& n = m_nodes[node];
+    auto [minX, maxX] = std::minmax_element(n.entries.begin(), n.entries.end(), [&](uint32_t a, uint32_t b) {
+        return centreX(entryBox(n, a)) < centreX(entryBox(n, b));
+    });
+    auto [minY, maxY] = std::minmax_element(n.entries.begin(), n.entries.end(), [&](uint32_t a, uint32_t b) {
+        return centreY(entryBox(n, a)) < centreY(entryBox(n, b));
+    });
+    bool byX = centreX(entryBox(n, *maxX)) - centreX(entryBox(n, *minX)) >=
+               centreY(entryBox(n, *maxY)) - centreY(entryBox(n, *minY));
+    std::sort(n.entries.begin(), n.entries.end(), [&](uint32_t a, uint32_t b) {
+        return byX ? centreX(entryBox(n, a)) < centreX(entryBox(n, b))
+                   : centreY(entryBox(n, a)) < centreY(entryBox(n, b));
+    });
+    size_t half = n.entries.size() / 2;
+    m_nodes[sibling].entries.assign(n.entries.begin() + half, n.entries.end());
+    n.entries.resize(half);
+    recomputeBox(node);
+    recomputeBox(sibling);
+    return sibling;
+}
+
+// Adds id below node, descending into the child that grows least. Returns
+// the new sibling of node if it had to be split, kNone otherwise.
+uint32_t RTree::insertAt(uint32_t node, Id id) {
+    const Rect2D& r = m_rects[id];
+    if (m_nodes[node].leaf) {
+        m_nodes[node].entries.push_back(id);
+    } else {
+        uint32_t best = kNone;
+        int64_t bestGrowth = 0, bestArea = 0;
+        for (uint32_t child : m_nodes[node].entries) {
+            const Rect2D& box = m_nodes[child].box;
+            int64_t a = area(box);
+            int64_t growth = area(box + r) - a;
+            if (best == kNone || std::tie(growth, a) < std::tie(bestGrowth, bestArea)) {
+                best = child;
+                bestGrowth = growth;
+                bestArea = a;
+            }
+        }
+        uint32_t sibling = insertAt(best, id);
+        if (sibling != kNone) m_nodes[node].entries.push_back(sibling);
+    }
+    Node& n = m_nodes[node];
+    n.box = n.entries.size() == 1 && n.leaf ? r : n.box + r;
+    if (n.entries.size() > kMaxEntries) return split(node);
+    return kNone;
+}
+
+void RTree::insertRoot(Id id) {
+    uint32_t sibling = insertAt(m_root, id);
+    if (sibling == kNone) return;
+    uint32_t root = newNode(false);
+    m_nodes[root].entries = {m_root, sibling};
+    recomputeBox(root);
+    m_root = root;
+}
+
+RTree::Id RTree::insert(const Rect2D& r) {
+    Id id = static_cast<Id>(m_rects.size());
+    m_rects.push_back(r);
+    m_live.push_back(true);
+    ++m_size;
+    insertRoot(id);
+    return id;
+}
+
+// Removes id from the subtree whose boxes contain its rectangle. Emptied
+// nodes are dropped; the rest may stay underfull until the next build().
+bool RTree::removeAt(uint32_t node, Id id) {
+    Node& n = m_nodes[node];
+    if (n.leaf) {
+        auto it = std::find(n.entries.begin(), n.entries.end(), id);
+        if (it == n.entries.end()) return false;
+        n.entries.erase(it);
+        recomputeBox(node);
+        return true;
+    }
+    for (size_t k = 0; k < m_nodes[node].entries.size(); ++k) {
+        uint32_t child = m_nodes[node].entries[k];
+        if (!m_nodes[child].box.contains(m_rects[id]) || !removeAt(child, id)) continue;
+        if (m_nodes[child].entries.empty()) {
+            m_nodes[node].entries.erase(m_nodes[node].entries.begin() + k);
+            m_freeNodes.push_back(child);
+        }
+        recomputeBox(node);
+        return true;
+    }
+    return false;
+}
+
+bool RTree::remove(Id id) {
+    if (!contains(id) || !removeAt(m_root, id)) return false;
+    m_live[id] = false;
+    --m_size;
+    while (!m_nodes[m_root].leaf && m_nodes[m_root].entries.size() == 1) {
+        m_freeNodes.push_back(m_root);
+        m_root = m_nodes[m_root].entries[0];
+    }
+    if (!m_nodes[m_root].leaf && m_nodes[m_root].entries.empty()) m_nodes[m_root].leaf = true;
+    return true;
+}
+
+bool RTree::update(Id id, const Rect2D& r) {
+    if (!remove(id)) return false;
+    m_rects[id] = r;
+    m_live[id] = true;
+    ++m_size;
+    insertRoot(id);
+    return true;
+}
+
+void RTree::queryPoint(int x, int y, std::vector<Id>& out) const {
+    std::vector<uint32_t> stack{m_root};
+    while (!stack.empty()) {
+        const Node& n = m_nodes[stack.back()];
+        stack.pop_back();
+        for (uint32_t e : n.entries) {
+            if (!entryBox(n, e).contains(x, y)) continue;
+            if (n.leaf) out.push_back(e);
+            else stack.push_back(e);
+        }
+    }
+}
+
+void RTree::queryWindow(const Rect2D& window, std::vector<Id>& out) const {
+    std::vector<uint32_t> stack{m_root};
+    while (!stack.empty()) {
+        const Node& n = m_nodes[stack.back()];
+        stack.pop_back();
+        for (uint32_t e : n.entries) {
+            if (!entryBox(n, e).overlaps(window)) continue;
+            if (n.leaf) out.push_back(e);
+            else stack.push_back(e);
+        }
+    }
+}
+
+// Best-first search: nodes and rectangles share one queue ordered by their
+// distance to the point, so a rectangle leaves it only when nothing closer
+// can remain inside an unopened node.
+void RTree::nearest(int x, int y, size_t k, std::vector<Id>& out) const {
+    struct Candidate {
+        int64_t distance;
+        bool isRect;
+        uint32_t index;
+        bool operator>(const Candidate& o) const {
+            return std::tie(distance, o.isRect, index) > std::tie(o.distance, isRect, o.index);
+        }
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+    queue.push({m_nodes[m_root].box.distance2(x, y), false, m_root});
+    size_t found = 0;
+    while (!queue.empty() && found < k) {
+        Candidate c = queue.top();
+        queue.pop();
+        if (c.isRect) {
+            out.push_back(c.index);
+            ++found;
+            continue;
+        }
+        const Node& n = m_nodes[c.index];
+        for (uint32_t e : n.entries) queue.push({entryBox(n, e).distance2(x, y), n.leaf, e});
+    }
+}
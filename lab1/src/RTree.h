@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Rect2D.h"
+
+// R-tree over Rect2D. build() packs all rectangles bottom-up with the
+// Sort-Tile-Recursive method; insert(), remove() and update() keep the tree
+// valid afterwards without re-packing, so build() again after heavy churn.
+//
+// Rectangles are identified by the index they had in build() or the id
+// insert() returned. Window queries report positive-area overlaps
+// (Rect2D::overlaps) and point queries use the half-open Rect2D::contains.
+// Queries are const and may run concurrently with each other.
+class RTree {
+public:
+    using Id = uint32_t;
+    static constexpr size_t kMaxEntries = 16;
+
+private:
+    static constexpr uint32_t kNone = static_cast<uint32_t>(-1);
+
+    struct Node {
+        Rect2D box;
+        bool leaf = true;
+        std::vector<uint32_t> entries;  // rectangle ids in a leaf, child nodes otherwise
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_freeNodes;
+    uint32_t m_root = 0;
+    std::vector<Rect2D> m_rects;  // by id
+    std::vector<bool> m_live;
+    size_t m_size = 0;
+
+    uint32_t newNode(bool leaf);
+    const Rect2D& entryBox(const Node& node, uint32_t entry) const;
+    void recomputeBox(uint32_t node);
+    std::vector<uint32_t> pack(std::vector<uint32_t> items, bool leaf);
+    uint32_t split(uint32_t node);
+    uint32_t insertAt(uint32_t node, Id id);
+    void insertRoot(Id id);
+    bool removeAt(uint32_t node, Id id);
+
+public:
+    RTree() { build({}); }
+    explicit RTree(const std::vector<Rect2D>& rects) { build(rects); }
+
+    void build(const std::vector<Rect2D>& rects);
+
+    size_t size() const { return m_size; }
+    bool contains(Id id) const { return id < m_live.size() && m_live[id]; }
+    const Rect2D& rect(Id id) const { return m_rects[id]; }
+
+    Id insert(const Rect2D& r);
+    bool remove(Id id);
+    // Re-files id after its rectangle was moved or resized.
+    bool update(Id id, const Rect2D& r);
+
+    // Append matching ids to out, in no particular order.
+    void queryPoint(int x, int y, std::vector<Id>& out) const;
+    void queryWindow(const Rect2D& window, std::vector<Id>& out) const;
+    // The k rectangles closest to (x, y) (distance 0 inside), nearest first.
+    void nearest(int x, int y, size_t k, std::vector<Id>& out) const;
+};
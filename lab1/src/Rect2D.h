@@ -1,41 +1,113 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <type_traits>
 
+// Plain value type: trivially copyable and usable in constant expressions,
+// so arrays of rectangles can be memcpy'd and mapped from disk (RectFile.h).
 class Rect2D {
-    int x1, y1, x2, y2;
+    int x1 = 0, y1 = 0, x2 = 0, y2 = 0;
 
-    void normalize();
+    constexpr void normalize() {
+        if (x1 > x2) std::swap(x1, x2);
+        if (y1 > y2) std::swap(y1, y2);
+    }
 
 public:
-    Rect2D();
-    Rect2D(int x1, int y1, int x2, int y2);
-    Rect2D(const Rect2D& other);
+    constexpr Rect2D() = default;
+    constexpr Rect2D(int x1, int y1, int x2, int y2)
+        : x1(x1), y1(y1), x2(x2), y2(y2) {
+        normalize();
+    }
+    constexpr Rect2D(const Rect2D& other) = default;
     ~Rect2D() = default;
-    Rect2D& operator=(const Rect2D& other);
+    constexpr Rect2D& operator=(const Rect2D& other) = default;
 
-    int left() const { return std::min(x1, x2); }
-    int top() const { return std::min(y1, y2); }
-    int right() const { return std::max(x1, x2); }
-    int bottom() const { return std::max(y1, y2); }
-    int width() const { return right() - left(); }
-    int height() const { return bottom() - top(); }
+    constexpr int left() const { return std::min(x1, x2); }
+    constexpr int top() const { return std::min(y1, y2); }
+    constexpr int right() const { return std::max(x1, x2); }
+    constexpr int bottom() const { return std::max(y1, y2); }
+    constexpr int width() const { return right() - left(); }
+    constexpr int height() const { return bottom() - top(); }
 
-    void move(int dx, int dy);
-    void resize(int w, int h);
+    // Point test over the half-open area [left, right) x [top, bottom).
+    constexpr bool contains(int x, int y) const {
+        return left() <= x && x < right() && top() <= y && y < bottom();
+    }
+    // True if r lies within this rectangle, borders included.
+    constexpr bool contains(const Rect2D& r) const {
+        return left() <= r.left() && r.right() <= right() &&
+               top() <= r.top() && r.bottom() <= bottom();
+    }
 
-    Rect2D& operator++();
-    Rect2D operator++(int);
-    Rect2D& operator--();
-    Rect2D operator--(int);
+    // Positive-area overlap, i.e. *this - r is not the empty rectangle.
+    constexpr bool overlaps(const Rect2D& r) const {
+        return std::max(left(), r.left()) < std::min(right(), r.right()) &&
+               std::max(top(), r.top()) < std::min(bottom(), r.bottom());
+    }
+    // Squared distance from (x, y) to the nearest point of the rectangle.
+    constexpr int64_t distance2(int x, int y) const {
+        int64_t dx = x < left() ? int64_t(left()) - x : (x > right() ? int64_t(x) - right() : 0);
+        int64_t dy = y < top() ? int64_t(top()) - y : (y > bottom() ? int64_t(y) - bottom() : 0);
+        return dx * dx + dy * dy;
+    }
 
-    Rect2D operator+(const Rect2D& r) const;
-    Rect2D& operator+=(const Rect2D& r);
-    Rect2D operator-(const Rect2D& r) const;
-    Rect2D& operator-=(const Rect2D& r);
+    constexpr void move(int dx, int dy) {
+        x1 += dx; y1 += dy;
+        x2 += dx; y2 += dy;
+    }
+    constexpr void resize(int w, int h) {
+        if (w < 0 || h < 0) return;
+        x2 = x1 + w;
+        y2 = y1 + h;
+    }
 
-    bool operator==(const Rect2D& r) const;
-    bool operator!=(const Rect2D& r) const { return !(*this == r); }
+    constexpr Rect2D& operator++() {
+        x2++; y2++;
+        return *this;
+    }
+    constexpr Rect2D operator++(int) {
+        Rect2D old = *this;
+        ++(*this);
+        return old;
+    }
+    constexpr Rect2D& operator--() {
+        if (width() > 0) x2--;
+        if (height() > 0) y2--;
+        return *this;
+    }
+    constexpr Rect2D operator--(int) {
+        Rect2D old = *this;
+        --(*this);
+        return old;
+    }
+
+    constexpr Rect2D operator+(const Rect2D& r) const {
+        return Rect2D(std::min(left(), r.left()), std::min(top(), r.top()),
+                      std::max(right(), r.right()), std::max(bottom(), r.bottom()));
+    }
+    constexpr Rect2D& operator+=(const Rect2D& r) { return *this = *this + r; }
+    constexpr Rect2D operator-(const Rect2D& r) const {
+        int l = std::max(left(), r.left());
+        int t = std::max(top(), r.top());
+        int R = std::min(right(), r.right());
+        int B = std::min(bottom(), r.bottom());
+        if (l >= R || t >= B) return Rect2D(0, 0, 0, 0);
+        return Rect2D(l, t, R, B);
+    }
+    constexpr Rect2D& operator-=(const Rect2D& r) { return *this = *this - r; }
+
+    constexpr bool operator==(const Rect2D& r) const {
+        return left() == r.left() && top() == r.top() &&
+               right() == r.right() && bottom() == r.bottom();
+    }
+    constexpr bool operator!=(const Rect2D& r) const { return !(*this == r); }
 
     friend std::ostream& operator<<(std::ostream& os, const Rect2D& r);
     friend std::istream& operator>>(std::istream& is, Rect2D& r);
 };
+
+static_assert(std::is_trivially_copyable_v<Rect2D>);
+static_assert(std::is_standard_layout_v<Rect2D>);
+static_assert(sizeof(Rect2D) == 4 * sizeof(int32_t));
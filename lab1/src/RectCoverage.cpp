@@ -0,0 +1,332 @@
+#include "RectCoverage.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include "RectStrips.h"
+
+namespace {
+
+using Interval = std::pair<int, int>;  // [first, second)
+
+// Segment tree over the elementary intervals [ys[i], ys[i + 1]). Besides the
+// number of ranges covering a node whole, every node keeps, for j < k, the
+// length of its interval covered at least j + 1 times by ranges added at or
+// below it; the root's values are then those of the whole sweep line.
+class CoverTree {
+    const std::vector<int>& m_ys;
+    size_t m_k;
+    std::vector<int> m_count;
+    std::vector<uint64_t> m_len;  // node * m_k + j
+
+    // Nodes are laid out in preorder: the left child follows its parent and
+    // the right one follows the whole left subtree (2 * leaves - 1 nodes).
+    static size_t rightChild(size_t node, size_t lo, size_t mid) { return node + 2 * (mid - lo); }
+
+    void pull(size_t node, size_t lo, size_t hi) {
+        size_t mid = (lo + hi) / 2;
+        uint64_t full = uint64_t(int64_t(m_ys[hi]) - m_ys[lo]);
+        for (size_t j = 0; j < m_k; ++j) {
+            size_t c = static_cast<size_t>(m_count[node]);
+            uint64_t& len = m_len[node * m_k + j];
+            if (c > j) len = full;
+            else if (hi - lo == 1) len = 0;
+            else len = m_len[(node + 1) * m_k + j - c] + m_len[rightChild(node, lo, mid) * m_k + j - c];
+        }
+    }
+
+    void update(size_t node, size_t lo, size_t hi, size_t a, size_t b, int delta) {
+        if (a <= lo && hi <= b) {
+            m_count[node] += delta;
+        } else {
+            size_t mid = (lo + hi) / 2;
+            if (a < mid) update(node + 1, lo, mid, a, b, delta);
+            if (b > mid) update(rightChild(node, lo, mid), mid, hi, a, b, delta);
+        }
+        pull(node, lo, hi);
+    }
+
+    void covered(size_t node, size_t lo, size_t hi, size_t a, size_t b, std::vector<Interval>& out) const {
+        if (m_len[node * m_k] == 0) return;
+        if (m_count[node] > 0 || m_len[node * m_k] == uint64_t(int64_t(m_ys[hi]) - m_ys[lo])) {
+            int from = m_ys[std::max(lo, a)], to = m_ys[std::min(hi, b)];
+            if (!out.empty() && out.back().second == from) out.back().second = to;
+            else out.push_back({from, to});
+            return;
+        }
+        size_t mid = (lo + hi) / 2;
+        if (a < mid) covered(node + 1, lo, mid, a, b, out);
+        if (b > mid) covered(rightChild(node, lo, mid), mid, hi, a, b, out);
+    }
+
+public:
+    CoverTree(const std::vector<int>& ys, size_t k)
+        : m_ys(ys), m_k(k), m_count(2 * leaves() - 1), m_len((2 * leaves() - 1) * k) {}
+
+    size_t leaves() const { return m_ys.size() - 1; }
+    void add(size_t a, size_t b, int delta) {
+        if (a < b) update(0, 0, leaves(), a, b, delta);
+    }
+    // Length of the sweep line covered at least j + 1 times.
+    uint64_t length(size_t j) const { return m_len[j]; }
+    // Appends the covered parts of leaves [a, b) as coordinate intervals.
+    void coveredIntervals(size_t a, size_t b, std::vector<Interval>& out) const {
+        if (a < b) covered(0, 0, leaves(), a, b, out);
+    }
+};
+
+struct Event {
+    int at;
+    int delta;
+    uint32_t from;  // leaf range [from, to)
+    uint32_t to;
+};
+
+// One sweep event per edge perpendicular to the sweep direction; ys receives
+// the sorted distinct edge coordinates along the line.
+std::vector<Event> makeEvents(const std::vector<std::pair<Interval, Interval>>& boxes, std::vector<int>& ys) {
+    ys.clear();
+    for (const auto& [span, line] : boxes) {
+        ys.push_back(line.first);
+        ys.push_back(line.second);
+    }
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+    auto leaf = [&](int y) { return static_cast<uint32_t>(std::lower_bound(ys.begin(), ys.end(), y) - ys.begin()); };
+
+    std::vector<Event> events;
+    events.reserve(2 * boxes.size());
+    for (const auto& [span, line] : boxes) {
+        uint32_t a = leaf(line.first), b = leaf(line.second);
+        events.push_back({span.first, 1, a, b});
+        events.push_back({span.second, -1, a, b});
+    }
+    std::sort(events.begin(), events.end(), [](const Event& l, const Event& r) { return l.at < r.at; });
+    return events;
+}
+
+// atLeast[j] += area covered at least j + 1 times inside the strip
+// lo <= x < hi, by the rectangles of `in` clipped to it.
+void sweepStrip(const std::vector<Rect2D>& rects, const StripInput& in, int64_t lo, int64_t hi,
+                std::vector<uint64_t>& atLeast) {
+    std::vector<std::pair<Interval, Interval>> boxes;
+    boxes.reserve(in.carried.size() + static_cast<size_t>(in.end - in.begin));
+    auto clip = [&](const Rect2D& r) {
+        int64_t x1 = std::max<int64_t>(r.left(), lo), x2 = std::min<int64_t>(r.right(), hi);
+        if (x1 < x2 && r.height() > 0) boxes.push_back({{int(x1), int(x2)}, {r.top(), r.bottom()}});
+    };
+    for (uint32_t i : in.carried) clip(rects[i]);
+    for (const uint32_t* p = in.begin; p != in.end; ++p) clip(rects[*p]);
+    if (boxes.empty()) return;
+    std::vector<int> ys;
+    std::vector<Event> events = makeEvents(boxes, ys);
+    CoverTree tree(ys, atLeast.size());
+
+    int prev = events.front().at;
+    for (const Event& e : events) {
+        if (e.at != prev) {
+            uint64_t dx = uint64_t(int64_t(e.at) - prev);
+            for (size_t j = 0; j < atLeast.size(); ++j) atLeast[j] += tree.length(j) * dx;
+            prev = e.at;
+        }
+        tree.add(e.from, e.to, e.delta);
+    }
+}
+
+// atLeast[j] = area covered at least j + 1 times, j < k.
+std::vector<uint64_t> coverage(const std::vector<Rect2D>& rects, size_t k, ThreadPool* pool) {
+    std::vector<uint64_t> total(k, 0);
+    if (!pool) {
+        std::vector<uint32_t> all(rects.size());
+        std::iota(all.begin(), all.end(), 0u);
+        StripInput in{{}, all.data(), all.data() + all.size()};
+        sweepStrip(rects, in, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), total);
+        return total;
+    }
+
+    // Sorted by left edge once; each strip gets its slice plus the
+    // rectangles reaching in across its left border.
+    std::vector<uint32_t> order = byLeft(rects);
+    std::vector<int> lefts;
+    lefts.reserve(order.size());
+    for (uint32_t i : order) lefts.push_back(rects[i].left());
+    std::vector<int64_t> borders = stripBorders(lefts, 4 * (pool->size() + 1));
+    std::vector<StripInput> strips = cutStrips(rects, order, borders);
+
+    std::vector<std::vector<uint64_t>> parts(strips.size(), std::vector<uint64_t>(k, 0));
+    pool->parallelFor(parts.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s) sweepStrip(rects, strips[s], borders[s], borders[s + 1], parts[s]);
+    });
+    for (const std::vector<uint64_t>& part : parts)
+        for (size_t j = 0; j < k; ++j) total[j] += part[j];
+    return total;
+}
+
+std::vector<uint64_t> histogram(const std::vector<Rect2D>& rects, unsigned maxDepth, ThreadPool* pool) {
+    std::vector<uint64_t> atLeast = coverage(rects, maxDepth, pool);
+    bool any = false;
+    int x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+    for (const Rect2D& r : rects) {
+        if (r.width() == 0 || r.height() == 0) continue;
+        x1 = any ? std::min(x1, r.left()) : r.left();
+        y1 = any ? std::min(y1, r.top()) : r.top();
+        x2 = any ? std::max(x2, r.right()) : r.right();
+        y2 = any ? std::max(y2, r.bottom()) : r.bottom();
+        any = true;
+    }
+    uint64_t box = uint64_t(int64_t(x2) - x1) * uint64_t(int64_t(y2) - y1);
+
+    std::vector<uint64_t> out(maxDepth + 1);
+    for (unsigned d = 0; d <= maxDepth; ++d) {
+        uint64_t here = d == 0 ? box : atLeast[d - 1];
+        uint64_t above = d < maxDepth ? atLeast[d] : 0;
+        out[d] = here - above;
+    }
+    return out;
+}
+
+struct Edge {
+    OutlinePoint from;
+    OutlinePoint to;
+};
+
+// Parts of a that are not in b; both sorted and disjoint.
+std::vector<Interval> subtract(const std::vector<Interval>& a, const std::vector<Interval>& b) {
+    std::vector<Interval> out;
+    size_t j = 0;
+    for (const Interval& in : a) {
+        int cur = in.first;
+        while (j < b.size() && b[j].second <= cur) ++j;
+        for (size_t k = j; k < b.size() && b[k].first < in.second; ++k) {
+            if (b[k].first > cur) out.push_back({cur, b[k].first});
+            cur = std::max(cur, b[k].second);
+        }
+        if (cur < in.second) out.push_back({cur, in.second});
+    }
+    return out;
+}
+
+// Boundary edges perpendicular to the sweep: at each sweep position, the
+// covered parts of the line just before and just after it differ exactly
+// there. transpose sweeps over y and yields the horizontal edges. Edges are
+// directed to keep the covered side on their left (y up).
+void boundaryEdges(const std::vector<Rect2D>& rects, bool transpose, std::vector<Edge>& edges) {
+    std::vector<std::pair<Interval, Interval>> boxes;
+    for (const Rect2D& r : rects) {
+        if (r.width() == 0 || r.height() == 0) continue;
+        Interval xs{r.left(), r.right()}, ys{r.top(), r.bottom()};
+        boxes.push_back(transpose ? std::pair{ys, xs} : std::pair{xs, ys});
+    }
+    if (boxes.empty()) return;
+    std::vector<int> line;
+    std::vector<Event> events = makeEvents(boxes, line);
+    CoverTree tree(line, 1);
+
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    std::vector<Interval> before, after;
+    for (size_t g = 0; g < events.size();) {
+        size_t end = g;
+        while (end < events.size() && events[end].at == events[g].at) ++end;
+
+        ranges.clear();
+        for (size_t e = g; e < end; ++e) ranges.push_back({events[e].from, events[e].to});
+        std::sort(ranges.begin(), ranges.end());
+        size_t merged = 0;
+        for (size_t r = 1; r < ranges.size(); ++r) {
+            if (ranges[r].first <= ranges[merged].second) ranges[merged].second = std::max(ranges[merged].second, ranges[r].second);
+            else ranges[++merged] = ranges[r];
+        }
+        ranges.resize(merged + 1);
+
+        before.clear();
+        for (const auto& [a, b] : ranges) tree.coveredIntervals(a, b, before);
+        for (size_t e = g; e < end; ++e) tree.add(events[e].from, events[e].to, events[e].delta);
+        after.clear();
+        for (const auto& [a, b] : ranges) tree.coveredIntervals(a, b, after);
+
+        int s = events[g].at;
+        for (const Interval& in : subtract(after, before)) {  // covered side ahead of the sweep
+            if (transpose) edges.push_back({{in.first, s}, {in.second, s}});
+            else edges.push_back({{s, in.second}, {s, in.first}});
+        }
+        for (const Interval& in : subtract(before, after)) {  // covered side behind it
+            if (transpose) edges.push_back({{in.second, s}, {in.first, s}});
+            else edges.push_back({{s, in.first}, {s, in.second}});
+        }
+        g = end;
+    }
+}
+
+int sign(int64_t v) {
+    return (v > 0) - (v < 0);
+}
+
+bool pointLess(const OutlinePoint& a, const OutlinePoint& b) {
+    return a.x != b.x ? a.x < b.x : a.y < b.y;
+}
+
+}
+
+uint64_t unionArea(const std::vector<Rect2D>& rects) {
+    return coverage(rects, 1, nullptr)[0];
+}
+
+uint64_t unionArea(const std::vector<Rect2D>& rects, ThreadPool& pool) {
+    return coverage(rects, 1, &pool)[0];
+}
+
+uint64_t coveredAtLeast(const std::vector<Rect2D>& rects, unsigned k) {
+    if (k == 0) k = 1;
+    return coverage(rects, k, nullptr)[k - 1];
+}
+
+uint64_t coveredAtLeast(const std::vector<Rect2D>& rects, unsigned k, ThreadPool& pool) {
+    if (k == 0) k = 1;
+    return coverage(rects, k, &pool)[k - 1];
+}
+
+std::vector<uint64_t> depthHistogram(const std::vector<Rect2D>& rects, unsigned maxDepth) {
+    return histogram(rects, maxDepth, nullptr);
+}
+
+std::vector<uint64_t> depthHistogram(const std::vector<Rect2D>& rects, unsigned maxDepth, ThreadPool& pool) {
+    return histogram(rects, maxDepth, &pool);
+}
+
+// Links the boundary edges into loops. Where two regions touch at a corner,
+// four edges meet; taking the leftmost turn there keeps the regions apart.
+std::vector<Polygon> unionOutline(const std::vector<Rect2D>& rects) {
+    std::vector<Edge> edges;
+    boundaryEdges(rects, false, edges);
+    boundaryEdges(rects, true, edges);
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return pointLess(a.from, b.from); });
+
+    std::vector<bool> used(edges.size(), false);
+    std::vector<Polygon> polygons;
+    for (size_t start = 0; start < edges.size(); ++start) {
+        if (used[start]) continue;
+        Polygon polygon;
+        size_t cur = start;
+        while (!used[cur]) {
+            used[cur] = true;
+            polygon.push_back(edges[cur].from);
+            const Edge& in = edges[cur];
+            int dx = sign(int64_t(in.to.x) - in.from.x), dy = sign(int64_t(in.to.y) - in.from.y);
+            auto [first, last] = std::equal_range(edges.begin(), edges.end(), Edge{in.to, in.to},
+                                                  [](const Edge& a, const Edge& b) { return pointLess(a.from, b.from); });
+            size_t next = cur;
+            int bestTurn = 0;
+            for (auto it = first; it != last; ++it) {
+                int ox = sign(int64_t(it->to.x) - it->from.x), oy = sign(int64_t(it->to.y) - it->from.y);
+                int turn = dx * oy - dy * ox;  // +1 left, -1 right
+                if (next == cur || turn > bestTurn) {
+                    next = static_cast<size_t>(it - edges.begin());
+                    bestTurn = turn;
+                }
+            }
+            cur = next;
+        }
+        polygons.push_back(std::move(polygon));
+    }
+    return polygons;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Rect2D.h"
+#include "ThreadPool.h"
+
+// Area covered by a set of rectangles, from a sweep over x that keeps the
+// coverage of the sweep line in a segment tree over the distinct y edges.
+// Rectangles without area are ignored. The ThreadPool overloads sweep
+// vertical strips (cut at quantiles of the x edges) concurrently and add up
+// the results, which are exact because the strips do not overlap.
+
+// Area of the union.
+uint64_t unionArea(const std::vector<Rect2D>& rects);
+uint64_t unionArea(const std::vector<Rect2D>& rects, ThreadPool& pool);
+
+// Area covered by at least k of the rectangles (k >= 1).
+uint64_t coveredAtLeast(const std::vector<Rect2D>& rects, unsigned k);
+uint64_t coveredAtLeast(const std::vector<Rect2D>& rects, unsigned k, ThreadPool& pool);
+
+// out[d] = area covered exactly d times for d < maxDepth, out[maxDepth] =
+// area covered maxDepth times or more; out[0] counts the uncovered part of
+// the bounding box of all rectangles.
+std::vector<uint64_t> depthHistogram(const std::vector<Rect2D>& rects, unsigned maxDepth);
+std::vector<uint64_t> depthHistogram(const std::vector<Rect2D>& rects, unsigned maxDepth, ThreadPool& pool);
+
+struct OutlinePoint {
+    int x;
+    int y;
+    bool operator==(const OutlinePoint& o) const { return x == o.x && y == o.y; }
+};
+using Polygon = std::vector<OutlinePoint>;
+
+// Boundary of the union as rectilinear polygons, one per boundary loop,
+// listing corner vertices only. With y pointing up, outer boundaries run
+// counter-clockwise and holes clockwise (so the shoelace sum over all loops
+// equals unionArea()). Regions touching at a single corner stay separate.
+std::vector<Polygon> unionOutline(const std::vector<Rect2D>& rects);
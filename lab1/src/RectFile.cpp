@@ -0,0 +1,79 @@
+#include "RectFile.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+const char kMagic[4] = {'R', 'E', 'C', 'T'};
+const uint32_t kVersion = 1;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+};
+static_assert(sizeof(Header) == 16 && sizeof(Header) % alignof(Rect2D) == 0);
+
+}
+
+bool saveRects(const std::string& path, std::span<const Rect2D> rects) {
+    std::string tmp = path + ".tmp";
+    std::error_code ec;
+    {
+        std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+        if (!os) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        Header header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.count = rects.size();
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        os.write(reinterpret_cast<const char*>(rects.data()),
+                 static_cast<std::streamsize>(rects.size_bytes()));
+        if (!os.flush()) {
+            os.close();
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::error_code ignored;
+        std::filesystem::remove(tmp, ignored);
+        return false;
+    }
+    return true;
+}
+
+bool RectFile::open(const std::string& path) {
+    close();
+    if (!m_file.open(path)) return false;
+    Header header;
+    bool ok = m_file.size() >= sizeof(header);
+    if (ok) {
+        std::memcpy(&header, m_file.data(), sizeof(header));
+        ok = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+             header.count == (m_file.size() - sizeof(header)) / sizeof(Rect2D) &&
+             (m_file.size() - sizeof(header)) % sizeof(Rect2D) == 0;
+    }
+    if (!ok) {
+        m_file.close();
+        return false;
+    }
+    m_count = header.count;
+    return true;
+}
+
+void RectFile::close() {
+    m_file.close();
+    m_count = 0;
+}
+
+std::span<const Rect2D> RectFile::rects() const {
+    if (m_count == 0) return {};
+    return {reinterpret_cast<const Rect2D*>(m_file.data() + sizeof(Header)), m_count};
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <span>
+#include <string>
+#include "MappedFile.h"
+#include "Rect2D.h"
+
+// Binary rectangle arrays that load by mapping the file, without parsing.
+//
+// Layout (native byte order, no padding):
+//   char[4]  magic "RECT"
+//   uint32   version
+//   uint64   rectangle count
+//   count x Rect2D, i.e. int32 x1, y1, x2, y2
+//
+// The 16-byte header keeps the records aligned in the page-aligned mapping.
+// A file written on a host of the other byte order fails the version check.
+
+// Written to path + ".tmp" and renamed over path.
+bool saveRects(const std::string& path, std::span<const Rect2D> rects);
+
+class RectFile {
+    MappedFile m_file;
+    size_t m_count = 0;
+
+public:
+    RectFile() = default;
+    explicit RectFile(const std::string& path) { open(path); }
+
+    // False if the file cannot be mapped or is not a well-formed rect file.
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    size_t size() const { return m_count; }
+    // Valid until close(); empty if no file is open.
+    std::span<const Rect2D> rects() const;
+};
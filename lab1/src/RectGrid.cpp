@@ -0,0 +1,174 @@
+#include "RectGrid.h"
+#include <algorithm>
+
+RectGrid::RectGrid(const std::vector<Rect2D>& rects, int cellSize) : m_cellSize(cellSize) {
+    if (m_cellSize <= 0) {
+        std::vector<int> extents;
+        extents.reserve(rects.size());
+        for (const Rect2D& r : rects) extents.push_back(std::max(r.width(), r.height()));
+        auto median = extents.begin() + extents.size() / 2;
+        std::nth_element(extents.begin(), median, extents.end());
+        m_cellSize = rects.empty() ? 64 : static_cast<int>(std::clamp<int64_t>(2 * int64_t(*median), 1, 1 << 30));
+    }
+    for (const Rect2D& r : rects) insert(r);
+}
+
+int RectGrid::cellOf(int v) const {
+    return v >= 0 ? v / m_cellSize : static_cast<int>(-((-int64_t(v) + m_cellSize - 1) / m_cellSize));
+}
+
+uint64_t RectGrid::key(int cx, int cy) {
+    return (uint64_t(uint32_t(cx)) << 32) | uint32_t(cy);
+}
+
+const std::vector<RectGrid::Id>* RectGrid::cell(int cx, int cy) const {
+    auto it = m_cells.find(key(cx, cy));
+    return it == m_cells.end() ? nullptr : &it->second;
+}
+
+bool RectGrid::isLarge(const Rect2D& r) const {
+    return int64_t(cellOf(r.right())) - cellOf(r.left()) > kMaxCellSpan ||
+           int64_t(cellOf(r.bottom())) - cellOf(r.top()) > kMaxCellSpan;
+}
+
+// A rectangle covers the cells of its half-open area; one without area is
+// filed under the cell of its corner.
+void RectGrid::file(Id id) {
+    const Rect2D& r = m_rects[id];
+    if (isLarge(r)) {
+        m_large.push_back(id);
+        return;
+    }
+    int cx1 = cellOf(r.left()), cx2 = cellOf(std::max(r.left(), r.right() - 1));
+    int cy1 = cellOf(r.top()), cy2 = cellOf(std::max(r.top(), r.bottom() - 1));
+    for (int cx = cx1; cx <= cx2; ++cx)
+        for (int cy = cy1; cy <= cy2; ++cy) m_cells[key(cx, cy)].push_back(id);
+    if (m_maxCellX < m_minCellX) {
+        m_minCellX = cx1; m_maxCellX = cx2;
+        m_minCellY = cy1; m_maxCellY = cy2;
+    } else {
+        m_minCellX = std::min(m_minCellX, cx1); m_maxCellX = std::max(m_maxCellX, cx2);
+        m_minCellY = std::min(m_minCellY, cy1); m_maxCellY = std::max(m_maxCellY, cy2);
+    }
+}
+
+void RectGrid::unfile(Id id) {
+    const Rect2D& r = m_rects[id];
+    if (isLarge(r)) {
+        *std::find(m_large.begin(), m_large.end(), id) = m_large.back();
+        m_large.pop_back();
+        return;
+    }
+    int cx1 = cellOf(r.left()), cx2 = cellOf(std::max(r.left(), r.right() - 1));
+    int cy1 = cellOf(r.top()), cy2 = cellOf(std::max(r.top(), r.bottom() - 1));
+    for (int cx = cx1; cx <= cx2; ++cx) {
+        for (int cy = cy1; cy <= cy2; ++cy) {
+            auto it = m_cells.find(key(cx, cy));
+            std::vector<Id>& ids = it->second;
+            *std::find(ids.begin(), ids.end(), id) = ids.back();
+            ids.pop_back();
+            if (ids.empty()) m_cells.erase(it);
+        }
+    }
+}
+
+RectGrid::Id RectGrid::insert(const Rect2D& r) {
+    Id id = static_cast<Id>(m_rects.size());
+    m_rects.push_back(r);
+    m_live.push_back(true);
+    ++m_size;
+    file(id);
+    return id;
+}
+
+bool RectGrid::remove(Id id) {
+    if (!contains(id)) return false;
+    unfile(id);
+    m_live[id] = false;
+    --m_size;
+    return true;
+}
+
+bool RectGrid::update(Id id, const Rect2D& r) {
+    if (!contains(id)) return false;
+    unfile(id);
+    m_rects[id] = r;
+    file(id);
+    return true;
+}
+
+void RectGrid::queryPoint(int x, int y, std::vector<Id>& out) const {
+    for (Id id : m_large)
+        if (m_rects[id].contains(x, y)) out.push_back(id);
+    if (const std::vector<Id>* ids = cell(cellOf(x), cellOf(y)))
+        for (Id id : *ids)
+            if (m_rects[id].contains(x, y)) out.push_back(id);
+}
+
+// A rectangle spanning several cells is reported only from the cell that
+// holds the top-left corner of its overlap with the window, so no
+// per-query bookkeeping is needed to drop duplicates.
+void RectGrid::queryWindow(const Rect2D& window, std::vector<Id>& out) const {
+    if (window.width() == 0 || window.height() == 0) return;
+    for (Id id : m_large)
+        if (m_rects[id].overlaps(window)) out.push_back(id);
+    int cx1 = std::max(m_minCellX, cellOf(window.left()));
+    int cx2 = std::min(m_maxCellX, cellOf(window.right() - 1));
+    int cy1 = std::max(m_minCellY, cellOf(window.top()));
+    int cy2 = std::min(m_maxCellY, cellOf(window.bottom() - 1));
+    for (int cx = cx1; cx <= cx2; ++cx) {
+        for (int cy = cy1; cy <= cy2; ++cy) {
+            const std::vector<Id>* ids = cell(cx, cy);
+            if (!ids) continue;
+            for (Id id : *ids) {
+                const Rect2D& r = m_rects[id];
+                if (!r.overlaps(window)) continue;
+                if (cellOf(std::max(r.left(), window.left())) == cx &&
+                    cellOf(std::max(r.top(), window.top())) == cy)
+                    out.push_back(id);
+            }
+        }
+    }
+}
+
+// Visits rings of cells around the point, starting from the large
+// rectangles. A rectangle not filed in any visited cell lies outside the
+// visited square, so the search stops once the k-th best distance is within
+// the distance to the square's border.
+void RectGrid::nearest(int x, int y, size_t k, std::vector<Id>& out) const {
+    k = std::min(k, m_size);
+    if (k == 0) return;
+    int cx0 = cellOf(x), cy0 = cellOf(y);
+    std::vector<std::pair<int64_t, Id>> best;
+    for (Id id : m_large) best.push_back({m_rects[id].distance2(x, y), id});
+    if (m_maxCellX < m_minCellX) {  // nothing filed under cells
+        std::sort(best.begin(), best.end());
+        best.resize(k);
+        for (const auto& entry : best) out.push_back(entry.second);
+        return;
+    }
+    // Rings that miss every used cell are skipped.
+    int64_t first = std::max({0, m_minCellX - cx0, cx0 - m_maxCellX, m_minCellY - cy0, cy0 - m_maxCellY});
+    for (int64_t ring = first;; ++ring) {
+        for (int64_t cx = cx0 - ring; cx <= cx0 + ring; ++cx) {
+            if (cx < m_minCellX || cx > m_maxCellX) continue;
+            bool edge = cx == cx0 - ring || cx == cx0 + ring;
+            for (int64_t cy = cy0 - ring; cy <= cy0 + ring; cy += edge ? 1 : 2 * ring) {
+                if (cy >= m_minCellY && cy <= m_maxCellY)
+                    if (const std::vector<Id>* ids = cell(int(cx), int(cy)))
+                        for (Id id : *ids) best.push_back({m_rects[id].distance2(x, y), id});
+                if (ring == 0) break;
+            }
+        }
+        std::sort(best.begin(), best.end());
+        best.erase(std::unique(best.begin(), best.end()), best.end());
+        if (best.size() > k) best.resize(k);
+
+        bool coversAll = cx0 - ring <= m_minCellX && cx0 + ring >= m_maxCellX &&
+                         cy0 - ring <= m_minCellY && cy0 + ring >= m_maxCellY;
+        int64_t border = std::min({x - (cx0 - ring) * m_cellSize, (cx0 + ring + 1) * m_cellSize - x,
+                                   y - (cy0 - ring) * m_cellSize, (cy0 + ring + 1) * m_cellSize - y});
+        if (coversAll || (best.size() == k && best.back().first <= border * border)) break;
+    }
+    for (const auto& entry : best) out.push_back(entry.second);
+}
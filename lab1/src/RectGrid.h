@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Rect2D.h"
+
+// Uniform grid over Rect2D: every rectangle is filed under each square cell
+// it covers. Cheaper to update than RTree and as fast for rectangles of
+// similar size. Rectangles spanning more than kMaxCellSpan cells along an
+// axis are kept in a separate list that every query checks, so a few huge
+// ones cost a linear scan of that list rather than filing them under a vast
+// number of cells. Ids and query semantics are the same as RTree's.
+class RectGrid {
+public:
+    using Id = uint32_t;
+
+private:
+    int m_cellSize = 1;
+    std::unordered_map<uint64_t, std::vector<Id>> m_cells;
+    std::vector<Rect2D> m_rects;  // by id
+    std::vector<bool> m_live;
+    std::vector<Id> m_large;  // rectangles too big to file under their cells
+    size_t m_size = 0;
+    int m_minCellX = 0, m_minCellY = 0, m_maxCellX = -1, m_maxCellY = -1;  // cells ever used
+
+    int cellOf(int v) const;
+    static uint64_t key(int cx, int cy);
+    const std::vector<Id>* cell(int cx, int cy) const;
+    bool isLarge(const Rect2D& r) const;
+    void file(Id id);
+    void unfile(Id id);
+
+public:
+    static constexpr int64_t kMaxCellSpan = 16;
+
+    // cellSize 0 picks twice the median rectangle extent, which a few
+    // outsized rectangles cannot inflate.
+    explicit RectGrid(const std::vector<Rect2D>& rects = {}, int cellSize = 0);
+
+    int cellSize() const { return m_cellSize; }
+    size_t size() const { return m_size; }
+    bool contains(Id id) const { return id < m_live.size() && m_live[id]; }
+    const Rect2D& rect(Id id) const { return m_rects[id]; }
+
+    Id insert(const Rect2D& r);
+    bool remove(Id id);
+    bool update(Id id, const Rect2D& r);
+
+    void queryPoint(int x, int y, std::vector<Id>& out) const;
+    void queryWindow(const Rect2D& window, std::vector<Id>& out) const;
+    void nearest(int x, int y, size_t k, std::vector<Id>& out) const;
+};
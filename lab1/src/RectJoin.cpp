@@ -0,0 +1,78 @@
+#include "RectJoin.h"
+#include <algorithm>
+#include <cstdint>
+#include "RectStrips.h"
+
+namespace {
+
+// Adds one rectangle at the sweep line x = r.left(): partners that ended at
+// or before it leave the active list, the rest are checked in y.
+void insert(const Rect2D& r, size_t index, std::vector<uint32_t>& partners,
+            const std::vector<Rect2D>& partnerRects, bool fromA, const JoinFn& fn) {
+    for (size_t k = 0; k < partners.size();) {
+        uint32_t j = partners[k];
+        const Rect2D& p = partnerRects[j];
+        if (p.right() <= r.left()) {
+            partners[k] = partners.back();
+            partners.pop_back();
+            continue;
+        }
+        ++k;
+        if (std::max(r.top(), p.top()) >= std::min(r.bottom(), p.bottom())) continue;
+        if (fromA) fn(index, j, r - p);
+        else fn(j, index, p - r);
+    }
+}
+
+// Carried rectangles start out active without being compared to each other:
+// their overlaps start left of the strip and were reported by an earlier one.
+void sweepStrip(const std::vector<Rect2D>& a, const std::vector<Rect2D>& b, const StripInput& sa,
+                const StripInput& sb, const JoinFn& fn) {
+    std::vector<uint32_t> activeA = sa.carried;
+    std::vector<uint32_t> activeB = sb.carried;
+    const uint32_t* ia = sa.begin;
+    const uint32_t* ib = sb.begin;
+    while (ia != sa.end || ib != sb.end) {
+        if (ib == sb.end || (ia != sa.end && a[*ia].left() <= b[*ib].left())) {
+            uint32_t i = *ia++;
+            insert(a[i], i, activeB, b, true, fn);
+            activeA.push_back(i);
+        } else {
+            uint32_t j = *ib++;
+            insert(b[j], j, activeA, a, false, fn);
+            activeB.push_back(j);
+        }
+    }
+}
+
+}
+
+void intersectionJoin(const std::vector<Rect2D>& a, const std::vector<Rect2D>& b, const JoinFn& fn) {
+    std::vector<uint32_t> orderA = byLeft(a);
+    std::vector<uint32_t> orderB = byLeft(b);
+    StripInput sa{{}, orderA.data(), orderA.data() + orderA.size()};
+    StripInput sb{{}, orderB.data(), orderB.data() + orderB.size()};
+    sweepStrip(a, b, sa, sb, fn);
+}
+
+void intersectionJoin(const std::vector<Rect2D>& a, const std::vector<Rect2D>& b, const JoinFn& fn,
+                      ThreadPool& pool, size_t strips) {
+    if (strips == 0) strips = 4 * (pool.size() + 1);
+
+    // Each input is sorted by left edge once; strips take slices of that.
+    std::vector<uint32_t> orderA = byLeft(a);
+    std::vector<uint32_t> orderB = byLeft(b);
+
+    std::vector<int> lefts;
+    lefts.reserve(orderA.size() + orderB.size());
+    for (uint32_t i : orderA) lefts.push_back(a[i].left());
+    for (uint32_t j : orderB) lefts.push_back(b[j].left());
+    std::inplace_merge(lefts.begin(), lefts.begin() + orderA.size(), lefts.end());
+    std::vector<int64_t> borders = stripBorders(lefts, strips);
+
+    std::vector<StripInput> stripsA = cutStrips(a, orderA, borders);
+    std::vector<StripInput> stripsB = cutStrips(b, orderB, borders);
+    pool.parallelFor(borders.size() - 1, 1, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s) sweepStrip(a, b, stripsA[s], stripsB[s], fn);
+    });
+}
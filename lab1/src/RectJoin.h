@@ -0,0 +1,22 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include "Rect2D.h"
+#include "ThreadPool.h"
+
+// Receives an index into a, an index into b and their overlap a[i] - b[j].
+using JoinFn = std::function<void(size_t, size_t, const Rect2D&)>;
+
+// Calls fn once for every pair (i, j) whose rectangles overlap with positive
+// area, i.e. a[i] - b[j] is not the empty rectangle. A plane sweep over x
+// keeps the rectangles crossing the sweep line and compares only those, so
+// nothing is materialized beyond each input's index list sorted by left edge.
+void intersectionJoin(const std::vector<Rect2D>& a, const std::vector<Rect2D>& b, const JoinFn& fn);
+
+// Same, with the plane cut into vertical strips swept on pool. Each strip
+// sweeps the rectangles starting inside it, found by binary search, plus
+// those reaching in across its left border; a pair is reported by the strip
+// holding the left edge of its overlap only. fn is
+// called concurrently from the pool's threads. strips = 0 uses four per thread.
+void intersectionJoin(const std::vector<Rect2D>& a, const std::vector<Rect2D>& b, const JoinFn& fn,
+                      ThreadPool& pool, size_t strips = 0);
@@ -0,0 +1,326 @@
+#include "RectSet.h"
+#include <algorithm>
+#include "SimdCommon.h"
+
+namespace {
+
+// The four coordinate arrays of the set being updated and of the operand.
+// An operand with Each = false is a single rectangle applied to every element.
+struct Target {
+    int* x1;
+    int* y1;
+    int* x2;
+    int* y2;
+};
+
+struct Operand {
+    const int* x1;
+    const int* y1;
+    const int* x2;
+    const int* y2;
+};
+
+// Rect2D::operator- on normalized coordinates: an empty overlap is (0, 0, 0, 0).
+template<bool Each>
+void scalarIntersect(Target a, Operand b, size_t from, size_t n) {
+    for (size_t i = from; i < n; ++i) {
+        size_t j = Each ? i : 0;
+        int l = std::max(a.x1[i], b.x1[j]);
+        int t = std::max(a.y1[i], b.y1[j]);
+        int r = std::min(a.x2[i], b.x2[j]);
+        int bottom = std::min(a.y2[i], b.y2[j]);
+        if (l >= r || t >= bottom) l = t = r = bottom = 0;
+        a.x1[i] = l; a.y1[i] = t;
+        a.x2[i] = r; a.y2[i] = bottom;
+    }
+}
+
+template<bool Each>
+void scalarUnite(Target a, Operand b, size_t from, size_t n) {
+    for (size_t i = from; i < n; ++i) {
+        size_t j = Each ? i : 0;
+        a.x1[i] = std::min(a.x1[i], b.x1[j]);
+        a.y1[i] = std::min(a.y1[i], b.y1[j]);
+        a.x2[i] = std::max(a.x2[i], b.x2[j]);
+        a.y2[i] = std::max(a.y2[i], b.y2[j]);
+    }
+}
+
+#ifdef POST_SIMD_X86
+
+template<bool Each>
+POST_TARGET_AVX2 __m256i loadOperand(const int* p, size_t i) {
+    if (Each) return _mm256_load_si256(reinterpret_cast<const __m256i*>(p + i));
+    return _mm256_set1_epi32(*p);
+}
+
+POST_TARGET_AVX2 __m256i load(const int* p, size_t i) {
+    return _mm256_load_si256(reinterpret_cast<const __m256i*>(p + i));
+}
+
+POST_TARGET_AVX2 void store(int* p, size_t i, __m256i v) {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(p + i), v);
+}
+
+template<bool Each>
+POST_TARGET_AVX2 void avx2Intersect(Target a, Operand b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i l = _mm256_max_epi32(load(a.x1, i), loadOperand<Each>(b.x1, i));
+        __m256i t = _mm256_max_epi32(load(a.y1, i), loadOperand<Each>(b.y1, i));
+        __m256i r = _mm256_min_epi32(load(a.x2, i), loadOperand<Each>(b.x2, i));
+        __m256i bottom = _mm256_min_epi32(load(a.y2, i), loadOperand<Each>(b.y2, i));
+        __m256i keep = _mm256_and_si256(_mm256_cmpgt_epi32(r, l), _mm256_cmpgt_epi32(bottom, t));
+        store(a.x1, i, _mm256_and_si256(keep, l));
+        store(a.y1, i, _mm256_and_si256(keep, t));
+        store(a.x2, i, _mm256_and_si256(keep, r));
+        store(a.y2, i, _mm256_and_si256(keep, bottom));
+    }
+    scalarIntersect<Each>(a, b, i, n);
+}
+
+template<bool Each>
+POST_TARGET_AVX2 void avx2Unite(Target a, Operand b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        store(a.x1, i, _mm256_min_epi32(load(a.x1, i), loadOperand<Each>(b.x1, i)));
+        store(a.y1, i, _mm256_min_epi32(load(a.y1, i), loadOperand<Each>(b.y1, i)));
+        store(a.x2, i, _mm256_max_epi32(load(a.x2, i), loadOperand<Each>(b.x2, i)));
+        store(a.y2, i, _mm256_max_epi32(load(a.y2, i), loadOperand<Each>(b.y2, i)));
+    }
+    scalarUnite<Each>(a, b, i, n);
+}
+
+// The kernels below return where the scalar tail has to continue.
+POST_TARGET_AVX2 size_t avx2Add(int* p, size_t n, int d) {
+    const __m256i v = _mm256_set1_epi32(d);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) store(p, i, _mm256_add_epi32(load(p, i), v));
+    return i;
+}
+
+POST_TARGET_AVX2 size_t avx2Offset(int* out, const int* from, size_t n, int d) {
+    const __m256i v = _mm256_set1_epi32(d);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) store(out, i, _mm256_add_epi32(load(from, i), v));
+    return i;
+}
+
+POST_TARGET_AVX2 size_t avx2Areas(Operand a, int64_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i w = _mm256_sub_epi32(load(a.x2, i), load(a.x1, i));
+        __m256i h = _mm256_sub_epi32(load(a.y2, i), load(a.y1, i));
+        __m256i lo = _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(w)),
+                                      _mm256_cvtepi32_epi64(_mm256_castsi256_si128(h)));
+        __m256i hi = _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(w, 1)),
+                                      _mm256_cvtepi32_epi64(_mm256_extracti128_si256(h, 1)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 4), hi);
+    }
+    return i;
+}
+
+POST_TARGET_AVX2 unsigned laneMask(__m256i v) {
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(v)));
+}
+
+POST_TARGET_AVX2 size_t avx2Containing(Operand a, int x, int y, std::vector<size_t>& out, size_t n) {
+    const __m256i vx = _mm256_set1_epi32(x);
+    const __m256i vy = _mm256_set1_epi32(y);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i inX = _mm256_andnot_si256(_mm256_cmpgt_epi32(load(a.x1, i), vx),
+                                          _mm256_cmpgt_epi32(load(a.x2, i), vx));
+        __m256i inY = _mm256_andnot_si256(_mm256_cmpgt_epi32(load(a.y1, i), vy),
+                                          _mm256_cmpgt_epi32(load(a.y2, i), vy));
+        for (unsigned mask = laneMask(_mm256_and_si256(inX, inY)); mask; mask &= mask - 1)
+            out.push_back(i + lowestBit(mask));
+    }
+    return i;
+}
+
+POST_TARGET_AVX2 size_t avx2ContainedIn(Operand a, const Rect2D& r, std::vector<size_t>& out, size_t n) {
+    const __m256i l = _mm256_set1_epi32(r.left());
+    const __m256i t = _mm256_set1_epi32(r.top());
+    const __m256i right = _mm256_set1_epi32(r.right());
+    const __m256i bottom = _mm256_set1_epi32(r.bottom());
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i outside = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpgt_epi32(l, load(a.x1, i)), _mm256_cmpgt_epi32(load(a.x2, i), right)),
+            _mm256_or_si256(_mm256_cmpgt_epi32(t, load(a.y1, i)), _mm256_cmpgt_epi32(load(a.y2, i), bottom)));
+        for (unsigned mask = ~laneMask(outside) & 0xFFu; mask; mask &= mask - 1)
+            out.push_back(i + lowestBit(mask));
+    }
+    return i;
+}
+
+#endif
+
+bool useAvx2(SimdLevel level) {
+#ifdef POST_SIMD_X86
+    return level == SimdLevel::AVX2 && simdLevel() == SimdLevel::AVX2;
+#else
+    (void)level;
+    return false;
+#endif
+}
+
+// p[i] += d over [0, n).
+void addTo(int* p, size_t n, int d, SimdLevel level) {
+    size_t i = 0;
+#ifdef POST_SIMD_X86
+    if (useAvx2(level)) i = avx2Add(p, n, d);
+#endif
+    (void)level;
+    for (; i < n; ++i) p[i] += d;
+}
+
+// out[i] = from[i] + d over [0, n).
+void offsetFrom(int* out, const int* from, size_t n, int d, SimdLevel level) {
+    size_t i = 0;
+#ifdef POST_SIMD_X86
+    if (useAvx2(level)) i = avx2Offset(out, from, n, d);
+#endif
+    (void)level;
+    for (; i < n; ++i) out[i] = from[i] + d;
+}
+
+}
+
+RectSet::RectSet(const std::vector<Rect2D>& rects) {
+    reserve(rects.size());
+    for (const Rect2D& r : rects) push_back(r);
+}
+
+void RectSet::reserve(size_t n) {
+    m_x1.reserve(n); m_y1.reserve(n);
+    m_x2.reserve(n); m_y2.reserve(n);
+}
+
+void RectSet::clear() {
+    m_x1.clear(); m_y1.clear();
+    m_x2.clear(); m_y2.clear();
+}
+
+void RectSet::push_back(const Rect2D& r) {
+    m_x1.push_back(r.left()); m_y1.push_back(r.top());
+    m_x2.push_back(r.right()); m_y2.push_back(r.bottom());
+}
+
+std::vector<Rect2D> RectSet::toVector() const {
+    std::vector<Rect2D> out;
+    out.reserve(size());
+    for (size_t i = 0; i < size(); ++i) out.push_back((*this)[i]);
+    return out;
+}
+
+void RectSet::intersectWith(const Rect2D& r, SimdLevel level) {
+    const int x1 = r.left(), y1 = r.top(), x2 = r.right(), y2 = r.bottom();
+    Target a{m_x1.data(), m_y1.data(), m_x2.data(), m_y2.data()};
+    Operand b{&x1, &y1, &x2, &y2};
+#ifdef POST_SIMD_X86
+    if (useAvx2(level)) {
+        avx2Intersect<false>(a, b, size());
+        return;
+    }
+#endif
+    (void)level;
+    scalarIntersect<false>(a, b, 0, size());
+}
+
+void RectSet::uniteWith(const Rect2D& r, SimdLevel level) {
+    const int x1 = r.left(), y1 = r.top(), x2 = r.right(), y2 = r.bottom();
+    Target a{m_x1.data(), m_y1.data(), m_x2.data(), m_y2.data()};
+    Operand b{&x1, &y1, &x2, &y2};
+#ifdef POST_SIMD_X86
+    if (useAvx2(level)) {
+        avx2Unite<false>(a, b, size());
+        return;
+    }
+#endif
+    (void)level;
+    scalarUnite<false>(a, b, 0, size());
+}
+
+bool RectSet::intersectWith(const RectSet& other, SimdLevel level) {
+    if (other.size() != size()) return false;
+    Target a{m_x1.data(), m_y1.data(), m_x2.data(), m_y2.data()};
+    Operand b{other.m_x1.data(), other.m_y1.data(), other.m_x2.data(), other.m_y2.data()};
+#ifdef POST_SIMD_X86
+    if (useAvx2(level)) {
+        avx2Intersect<true>(a, b, size());
+        return true;
+    }
+#endif
+    (void)level;
+    scalarIntersect<true>(a, b, 0, size());
+    return true;
+}
+
+bool RectSet::uniteWith(const RectSet& other, SimdLevel level) {
+    if (other.size() != size()) return false;
+    Target a{m_x1.data(), m_y1.data(), m_x2.data(), m_y2.data()};
+    Operand b{other.m_x1.data(), other.m_y1.data(), other.m_x2.data(), other.m_y2.data()};
+#ifdef POST_SIMD_X86
+    if (useAvx2(level)) {
+        avx2Unite<true>(a, b, size());
+        return true;
+    }
+#endif
+    (void)level;
+    scalarUnite<true>(a, b, 0, size());
+    return true;
+}
+
+void RectSet::move(int dx, int dy, SimdLevel level) {
+    addTo(m_x1.data(), size(), dx, level);
+    addTo(m_y1.data(), size(), dy, level);
+    addTo(m_x2.data(), size(), dx, level);
+    addTo(m_y2.data(), size(), dy, level);
+}
+
+// Like Rect2D::resize(): negative sizes leave the rectangles unchanged.
+void RectSet::resize(int w, int h, SimdLevel level) {
+    if (w < 0 || h < 0) return;
+    offsetFrom(m_x2.data(), m_x1.data(), size(), w, level);
+    offsetFrom(m_y2.data(), m_y1.data(), size(), h, level);
+}
+
+void RectSet::areas(std::vector<int64_t>& out, SimdLevel level) const {
+    size_t n = size();
+    out.resize(n);
+    size_t i = 0;
+#ifdef POST_SIMD_X86
+    if (useAvx2(level))
+        i = avx2Areas({m_x1.data(), m_y1.data(), m_x2.data(), m_y2.data()}, out.data(), n);
+#endif
+    (void)level;
+    for (; i < n; ++i) out[i] = static_cast<int64_t>(m_x2[i] - m_x1[i]) * (m_y2[i] - m_y1[i]);
+}
+
+void RectSet::containing(int x, int y, std::vector<size_t>& out, SimdLevel level) const {
+    size_t n = size();
+    size_t i = 0;
+#ifdef POST_SIMD_X86
+    if (useAvx2(level))
+        i = avx2Containing({m_x1.data(), m_y1.data(), m_x2.data(), m_y2.data()}, x, y, out, n);
+#endif
+    (void)level;
+    for (; i < n; ++i)
+        if (m_x1[i] <= x && x < m_x2[i] && m_y1[i] <= y && y < m_y2[i]) out.push_back(i);
+}
+
+void RectSet::containedIn(const Rect2D& r, std::vector<size_t>& out, SimdLevel level) const {
+    size_t n = size();
+    size_t i = 0;
+#ifdef POST_SIMD_X86
+    if (useAvx2(level))
+        i = avx2ContainedIn({m_x1.data(), m_y1.data(), m_x2.data(), m_y2.data()}, r, out, n);
+#endif
+    (void)level;
+    for (; i < n; ++i)
+        if (r.left() <= m_x1[i] && m_x2[i] <= r.right() && r.top() <= m_y1[i] && m_y2[i] <= r.bottom())
+            out.push_back(i);
+}
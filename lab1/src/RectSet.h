@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "Rect2D.h"
+#include "SimdSearch.h"
+
+// Allocator for vectors whose data must start on an Align-byte boundary.
+template<class T, size_t Align>
+struct AlignedAllocator {
+    using value_type = T;
+    template<class U> struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() = default;
+    template<class U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(Align)); }
+
+    template<class U> bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+    template<class U> bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+};
+
+// Rectangles stored as four coordinate arrays (structure of arrays), each
+// 32-byte aligned, so batch operations process eight rectangles per AVX2
+// instruction. Coordinates are kept normalized (x1 <= x2, y1 <= y2) and every
+// batch operation gives exactly what the matching Rect2D operation gives for
+// each element. The level argument selects the kernel; anything below AVX2
+// runs the scalar loop.
+class RectSet {
+public:
+    using Coords = std::vector<int, AlignedAllocator<int, 32>>;
+
+private:
+    Coords m_x1, m_y1, m_x2, m_y2;
+
+public:
+    RectSet() = default;
+    explicit RectSet(const std::vector<Rect2D>& rects);
+
+    size_t size() const { return m_x1.size(); }
+    bool empty() const { return m_x1.empty(); }
+    void reserve(size_t n);
+    void clear();
+    void push_back(const Rect2D& r);
+    Rect2D operator[](size_t i) const { return Rect2D(m_x1[i], m_y1[i], m_x2[i], m_y2[i]); }
+    std::vector<Rect2D> toVector() const;
+
+    const Coords& x1() const { return m_x1; }
+    const Coords& y1() const { return m_y1; }
+    const Coords& x2() const { return m_x2; }
+    const Coords& y2() const { return m_y2; }
+
+    // set[i] -= r / set[i] += r for every element.
+    void intersectWith(const Rect2D& r, SimdLevel level = simdLevel());
+    void uniteWith(const Rect2D& r, SimdLevel level = simdLevel());
+    // Element-wise set[i] -= other[i] / set[i] += other[i]; false if the sizes differ.
+    bool intersectWith(const RectSet& other, SimdLevel level = simdLevel());
+    bool uniteWith(const RectSet& other, SimdLevel level = simdLevel());
+
+    void move(int dx, int dy, SimdLevel level = simdLevel());
+    void resize(int w, int h, SimdLevel level = simdLevel());
+
+    // out[i] = width * height of set[i], widened to 64 bits.
+    void areas(std::vector<int64_t>& out, SimdLevel level = simdLevel()) const;
+    // Appends the indices i with set[i].contains(x, y) / r.contains(set[i]).
+    void containing(int x, int y, std::vector<size_t>& out, SimdLevel level = simdLevel()) const;
+    void containedIn(const Rect2D& r, std::vector<size_t>& out, SimdLevel level = simdLevel()) const;
+};
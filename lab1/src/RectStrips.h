@@ -0,0 +1,62 @@
+#pragma once
+// Internal to the strip-parallel sweeps (RectJoin.cpp, RectCoverage.cpp):
+// each input is sorted by left edge once and cut into vertical strips by
+// binary search. Not a public header.
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Rect2D.h"
+
+// Indices of the rectangles with area, by left edge.
+inline std::vector<uint32_t> byLeft(const std::vector<Rect2D>& rects) {
+    std::vector<uint32_t> order;
+    order.reserve(rects.size());
+    for (size_t i = 0; i < rects.size(); ++i)
+        if (rects[i].width() > 0 && rects[i].height() > 0) order.push_back(static_cast<uint32_t>(i));
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t x, uint32_t y) { return rects[x].left() < rects[y].left(); });
+    return order;
+}
+
+// Borders of at most `strips` strips at quantiles of the sorted left edges,
+// which balances the sweeps; the outer borders are the int64_t limits.
+inline std::vector<int64_t> stripBorders(const std::vector<int>& lefts, size_t strips) {
+    std::vector<int64_t> borders{std::numeric_limits<int64_t>::min()};
+    for (size_t s = 1; s < strips && !lefts.empty(); ++s) {
+        int64_t border = lefts[s * lefts.size() / strips];
+        if (border > borders.back()) borders.push_back(border);
+    }
+    borders.push_back(std::numeric_limits<int64_t>::max());
+    return borders;
+}
+
+// What one input contributes to the sweep of a strip [lo, hi): the
+// rectangles that start left of lo and reach into the strip, and the slice
+// of the left-edge order that starts inside it.
+struct StripInput {
+    std::vector<uint32_t> carried;
+    const uint32_t* begin = nullptr;
+    const uint32_t* end = nullptr;
+};
+
+// Cuts order at the strip borders by binary search; the rectangles reaching
+// across each border are collected in one pass from left to right.
+inline std::vector<StripInput> cutStrips(const std::vector<Rect2D>& rects, const std::vector<uint32_t>& order,
+                                         const std::vector<int64_t>& borders) {
+    std::vector<StripInput> strips(borders.size() - 1);
+    std::vector<uint32_t> open;
+    const uint32_t* at = order.data();
+    const uint32_t* last = order.data() + order.size();
+    for (size_t s = 0; s < strips.size(); ++s) {
+        int64_t hi = borders[s + 1];
+        strips[s].carried = open;
+        strips[s].begin = at;
+        at = std::partition_point(at, last, [&](uint32_t i) { return rects[i].left() < hi; });
+        strips[s].end = at;
+        std::erase_if(open, [&](uint32_t i) { return rects[i].right() <= hi; });
+        for (const uint32_t* p = strips[s].begin; p != at; ++p)
+            if (rects[*p].right() > hi) open.push_back(*p);
+    }
+    return strips;
+}
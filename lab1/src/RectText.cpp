@@ -0,0 +1,115 @@
+#include "RectText.h"
+#include <charconv>
+#include "MappedFile.h"
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+template<class Sink>
+RectParseResult parse(std::string_view text, Sink sink) {
+    RectParseResult result;
+    const char* at = text.data();
+    const char* end = at + text.size();
+    const char* lineStart = at;
+    size_t line = 1;
+    size_t recordLine = 0, recordColumn = 0;
+    int v[4];
+    int field = 0;
+
+    auto fail = [&](size_t errorLine, size_t column, std::string message) {
+        result.ok = false;
+        result.line = errorLine;
+        result.column = column;
+        result.message = std::move(message);
+        return result;
+    };
+    auto column = [&](const char* p) { return static_cast<size_t>(p - lineStart) + 1; };
+
+    for (;;) {
+        while (at < end && isSpace(*at)) {
+            if (*at == '\n') {
+                ++line;
+                lineStart = at + 1;
+            }
+            ++at;
+        }
+        if (at == end) break;
+        const char* token = at;
+        // operator>> accepts a leading '+', from_chars does not.
+        if (*at == '+' && at + 1 < end && at[1] != '-') ++at;
+        auto [next, ec] = std::from_chars(at, end, v[field]);
+        if (ec == std::errc::invalid_argument) return fail(line, column(token), "expected an integer");
+        if (ec == std::errc::result_out_of_range) return fail(line, column(token), "integer out of range");
+        if (next < end && !isSpace(*next)) return fail(line, column(next), "unexpected character after integer");
+        if (field == 0) {
+            recordLine = line;
+            recordColumn = column(token);
+        }
+        at = next;
+        if (++field == 4) {
+            sink(Rect2D(v[0], v[1], v[2], v[3]));
+            ++result.count;
+            field = 0;
+        }
+    }
+    if (field != 0) {
+        return fail(recordLine, recordColumn,
+                    "incomplete record: " + std::to_string(field) + " of 4 integers");
+    }
+    return result;
+}
+
+template<class Out>
+RectParseResult load(const std::string& path, Out& out) {
+    MappedFile file;
+    if (!file.open(path)) {
+        RectParseResult result;
+        result.ok = false;
+        result.message = "cannot open " + path;
+        return result;
+    }
+    return parseRects(std::string_view(file.data(), file.size()), out);
+}
+
+}
+
+RectParseResult parseRects(std::string_view text, std::vector<Rect2D>& out) {
+    return parse(text, [&](const Rect2D& r) { out.push_back(r); });
+}
+
+RectParseResult parseRects(std::string_view text, RectSet& out) {
+    return parse(text, [&](const Rect2D& r) { out.push_back(r); });
+}
+
+RectParseResult loadRects(const std::string& path, std::vector<Rect2D>& out) {
+    return load(path, out);
+}
+
+RectParseResult loadRects(const std::string& path, RectSet& out) {
+    return load(path, out);
+}
+
+char* formatRect(char* at, const Rect2D& r) {
+    char* end = at + kRectTextMax;
+    at = std::to_chars(at, end, r.left()).ptr;
+    *at++ = ' ';
+    at = std::to_chars(at, end, r.top()).ptr;
+    *at++ = ' ';
+    at = std::to_chars(at, end, r.right()).ptr;
+    *at++ = ' ';
+    return std::to_chars(at, end, r.bottom()).ptr;
+}
+
+void formatRects(std::span<const Rect2D> rects, std::string& out) {
+    size_t start = out.size();
+    out.resize(start + rects.size() * (kRectTextMax + 1));
+    char* at = out.data() + start;
+    for (const Rect2D& r : rects) {
+        at = formatRect(at, r);
+        *at++ = '\n';
+    }
+    out.resize(static_cast<size_t>(at - out.data()));
+}
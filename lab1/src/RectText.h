@@ -0,0 +1,37 @@
+#pragma once
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Rect2D.h"
+#include "RectSet.h"
+
+// Bulk text I/O in the format of Rect2D's stream operators: four integers
+// "x1 y1 x2 y2" per rectangle, separated by any whitespace. Records are
+// normalized as operator>> does. Parsing uses std::from_chars, without
+// locales or streams.
+
+struct RectParseResult {
+    bool ok = true;
+    size_t count = 0;    // rectangles appended to the output
+    // Position of the first error, both 1-based, column in bytes.
+    size_t line = 0;
+    size_t column = 0;
+    std::string message;
+};
+
+// Appends the rectangles in text to out. On an error out keeps the records
+// before it and the result says where parsing stopped.
+RectParseResult parseRects(std::string_view text, std::vector<Rect2D>& out);
+RectParseResult parseRects(std::string_view text, RectSet& out);
+// Same over a memory-mapped file.
+RectParseResult loadRects(const std::string& path, std::vector<Rect2D>& out);
+RectParseResult loadRects(const std::string& path, RectSet& out);
+
+// Longest formatRect() output: four signed 32-bit integers and three spaces.
+constexpr size_t kRectTextMax = 4 * 11 + 3;
+
+// Writes r as operator<< does, without a terminator; returns the end.
+char* formatRect(char* at, const Rect2D& r);
+// Appends one line per rectangle to out.
+void formatRects(std::span<const Rect2D> rects, std::string& out);
@@ -0,0 +1,144 @@
+#include "RleTape.h"
+#include <algorithm>
+
+namespace {
+const size_t kExpandChunk = 4096;
+}
+
+RleTape::RleTape(const std::string& data) : m_size(data.length()) {
+    encode(data.data(), data.length(), m_runs);
+}
+
+std::unique_ptr<TapeStorage> RleTape::clone() const {
+    return std::make_unique<RleTape>(*this);
+}
+
+void RleTape::encode(const char* data, size_t n, std::vector<Run>& runs) {
+    for (size_t i = 0; i < n; ++i) {
+        if (!runs.empty() && runs.back().symbol == data[i])
+            ++runs.back().count;
+        else
+            runs.push_back({data[i], 1});
+    }
+}
+
+// Index of the run holding pos (m_runs.size() for pos == size()); leaves the
+// cursor on that run.
+size_t RleTape::locate(size_t pos) const {
+    if (m_cursorRun > m_runs.size() || m_cursorStart > pos) {
+        m_cursorRun = 0;
+        m_cursorStart = 0;
+    }
+    while (m_cursorRun < m_runs.size() && m_cursorStart + m_runs[m_cursorRun].count <= pos) {
+        m_cursorStart += m_runs[m_cursorRun].count;
+        ++m_cursorRun;
+    }
+    return m_cursorRun;
+}
+
+// Makes pos the start of a run and returns that run's index.
+size_t RleTape::splitAt(size_t pos) {
+    size_t i = locate(pos);
+    if (i == m_runs.size() || m_cursorStart == pos) return i;
+    size_t head = pos - m_cursorStart;
+    m_runs.insert(m_runs.begin() + i + 1, {m_runs[i].symbol, m_runs[i].count - head});
+    m_runs[i].count = head;
+    m_cursorStart = pos;
+    m_cursorRun = i + 1;
+    return i + 1;
+}
+
+// Drops empty runs and joins equal neighbours among runs [from, to].
+void RleTape::mergeAround(size_t from, size_t to) {
+    m_cursorRun = 0;
+    m_cursorStart = 0;
+    if (m_runs.empty()) return;
+    to = std::min(to, m_runs.size() - 1);
+    size_t out = from;
+    for (size_t i = from; i <= to; ++i) {
+        if (m_runs[i].count == 0) continue;
+        if (out > from && m_runs[out - 1].symbol == m_runs[i].symbol)
+            m_runs[out - 1].count += m_runs[i].count;
+        else
+            m_runs[out++] = m_runs[i];
+    }
+    m_runs.erase(m_runs.begin() + out, m_runs.begin() + to + 1);
+}
+
+void RleTape::replace(size_t pos, size_t len, const std::string& text) {
+    m_size = m_size - len + text.length();
+
+    // A rewrite that stays inside one run and only uses its symbol is a
+    // counter update.
+    size_t i = locate(pos);
+    if (i < m_runs.size() && pos + len <= m_cursorStart + m_runs[i].count &&
+        text.find_first_not_of(m_runs[i].symbol) == std::string::npos) {
+        m_runs[i].count = m_runs[i].count - len + text.length();
+        if (m_runs[i].count == 0) mergeAround(i > 0 ? i - 1 : 0, i + 1);
+        return;
+    }
+
+    size_t first = splitAt(pos);
+    size_t last = splitAt(pos + len);
+    std::vector<Run> inserted;
+    encode(text.data(), text.length(), inserted);
+    m_runs.erase(m_runs.begin() + first, m_runs.begin() + last);
+    m_runs.insert(m_runs.begin() + first, inserted.begin(), inserted.end());
+    mergeAround(first > 0 ? first - 1 : 0, first + inserted.size());
+}
+
+void RleTape::forEachChunk(size_t from, size_t to, const ChunkFn& fn) const {
+    to = std::min(to, m_size);
+    if (from >= to) return;
+    std::string buffer;
+    size_t i = locate(from);
+    size_t runStart = m_cursorStart;
+    size_t offset = from;
+    while (offset < to) {
+        buffer.clear();
+        size_t chunkStart = offset;
+        while (offset < to && buffer.length() < kExpandChunk) {
+            size_t runEnd = runStart + m_runs[i].count;
+            size_t take = std::min({runEnd, to, offset + kExpandChunk - buffer.length()}) - offset;
+            buffer.append(take, m_runs[i].symbol);
+            offset += take;
+            if (offset == runEnd) {
+                runStart = runEnd;
+                ++i;
+            }
+        }
+        if (!fn(buffer.data(), buffer.length(), chunkStart)) return;
+    }
+}
+
+size_t RleTape::find(const std::string& pattern, size_t from) const {
+    if (pattern.empty() || from >= m_size) return npos;
+    std::vector<Run> p;
+    encode(pattern.data(), pattern.length(), p);
+
+    size_t i = locate(from);
+    size_t runStart = m_cursorStart;
+    for (; i < m_runs.size(); runStart += m_runs[i].count, ++i) {
+        const Run& run = m_runs[i];
+        size_t available = runStart + run.count - std::max(runStart, from);
+        if (run.symbol != p[0].symbol || available < p[0].count) continue;
+        if (p.size() == 1) return std::max(runStart, from);
+
+        // Inner pattern runs must match whole tape runs; the outer ones may
+        // take the tail of the first run and the head of the last.
+        if (i + p.size() - 1 >= m_runs.size()) return npos;
+        bool match = true;
+        for (size_t k = 1; k < p.size() && match; ++k) {
+            const Run& next = m_runs[i + k];
+            bool inner = k + 1 < p.size();
+            match = next.symbol == p[k].symbol &&
+                    (inner ? next.count == p[k].count : next.count >= p[k].count);
+        }
+        if (match) return runStart + run.count - p[0].count;
+    }
+    return npos;
+}
+
+void RleTape::countSymbols(std::array<size_t, 256>& counts) const {
+    for (const Run& run : m_runs) counts[static_cast<unsigned char>(run.symbol)] += run.count;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include "TapeStorage.h"
+
+// Run-length encoded tape for programs over long runs of one symbol, such
+// as unary arithmetic. Patterns are matched against the runs and a rewrite
+// inside a run only adjusts its counter.
+class RleTape : public TapeStorage {
+    struct Run {
+        char symbol;
+        size_t count;
+    };
+
+    std::vector<Run> m_runs;
+    size_t m_size = 0;
+    mutable size_t m_cursorRun = 0;    // run last located and its start, so
+    mutable size_t m_cursorStart = 0;  // nearby lookups do not walk from 0
+
+    static void encode(const char* data, size_t n, std::vector<Run>& runs);
+    size_t locate(size_t pos) const;
+    size_t splitAt(size_t pos);
+    void mergeAround(size_t from, size_t to);
+
+public:
+    explicit RleTape(const std::string& data);
+
+    std::unique_ptr<TapeStorage> clone() const override;
+    size_t size() const override { return m_size; }
+    char at(size_t i) const override { return m_runs[locate(i)].symbol; }
+    void replace(size_t pos, size_t len, const std::string& text) override;
+    void forEachChunk(size_t from, size_t to, const ChunkFn& fn) const override;
+    size_t find(const std::string& pattern, size_t from) const override;
+    bool compressed() const override { return true; }
+    void countSymbols(std::array<size_t, 256>& counts) const override;
+
+    size_t runCount() const { return m_runs.size(); }
+};
@@ -0,0 +1,178 @@
+#include "RopeTape.h"
+#include <algorithm>
+
+namespace {
+const size_t kPieceSize = 512;
+}
+
+RopeTape::RopeTape(const std::string& data) {
+    m_root = build(data.data(), data.length());
+}
+
+std::unique_ptr<TapeStorage> RopeTape::clone() const {
+    return std::make_unique<RopeTape>(*this);
+}
+
+void RopeTape::update(int t) {
+    Node& n = m_nodes[t];
+    n.size = sizeOf(n.left) + n.text.length() + sizeOf(n.right);
+}
+
+int RopeTape::newNode(std::string text, uint32_t priority) {
+    int t;
+    if (!m_free.empty()) {
+        t = m_free.back();
+        m_free.pop_back();
+    } else {
+        t = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    Node& n = m_nodes[t];
+    n.text = std::move(text);
+    n.priority = priority;
+    n.left = n.right = -1;
+    n.size = n.text.length();
+    ++m_pieces;
+    return t;
+}
+
+int RopeTape::newNode(std::string text) {
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return newNode(std::move(text), m_seed);
+}
+
+void RopeTape::release(int t) {
+    if (t < 0) return;
+    release(m_nodes[t].left);
+    release(m_nodes[t].right);
+    m_nodes[t].text.clear();
+    m_free.push_back(t);
+    --m_pieces;
+}
+
+// Splits t into a (first k symbols) and b (the rest), cutting a piece in two
+// when k falls inside it.
+void RopeTape::split(int t, size_t k, int& a, int& b) {
+    if (t < 0) {
+        a = b = -1;
+        return;
+    }
+    size_t leftSize = sizeOf(m_nodes[t].left);
+    size_t ownSize = m_nodes[t].text.length();
+    // Children are written back after the recursion: newNode() may grow m_nodes.
+    if (k <= leftSize) {
+        int rest;
+        split(m_nodes[t].left, k, a, rest);
+        m_nodes[t].left = rest;
+        update(t);
+        b = t;
+    } else if (k >= leftSize + ownSize) {
+        int rest;
+        split(m_nodes[t].right, k - leftSize - ownSize, rest, b);
+        m_nodes[t].right = rest;
+        update(t);
+        a = t;
+    } else {
+        size_t cut = k - leftSize;
+        // The tail piece inherits the priority, so it may take over the right subtree.
+        int tail = newNode(m_nodes[t].text.substr(cut), m_nodes[t].priority);
+        m_nodes[t].text.resize(cut);
+        m_nodes[tail].right = m_nodes[t].right;
+        m_nodes[t].right = -1;
+        update(tail);
+        update(t);
+        a = t;
+        b = tail;
+    }
+}
+
+int RopeTape::merge(int a, int b) {
+    if (a < 0) return b;
+    if (b < 0) return a;
+    if (m_nodes[a].priority >= m_nodes[b].priority) {
+        int r = merge(m_nodes[a].right, b);
+        m_nodes[a].right = r;
+        update(a);
+        return a;
+    }
+    int l = merge(a, m_nodes[b].left);
+    m_nodes[b].left = l;
+    update(b);
+    return b;
+}
+
+int RopeTape::build(const char* data, size_t n) {
+    int t = -1;
+    for (size_t i = 0; i < n; i += kPieceSize)
+        t = merge(t, newNode(std::string(data + i, std::min(kPieceSize, n - i))));
+    return t;
+}
+
+char RopeTape::at(size_t i) const {
+    int t = m_root;
+    while (true) {
+        const Node& n = m_nodes[t];
+        size_t leftSize = sizeOf(n.left);
+        if (i < leftSize) {
+            t = n.left;
+        } else if (i < leftSize + n.text.length()) {
+            return n.text[i - leftSize];
+        } else {
+            i -= leftSize + n.text.length();
+            t = n.right;
+        }
+    }
+}
+
+void RopeTape::replace(size_t pos, size_t len, const std::string& text) {
+    int a, rest, b, c;
+    split(m_root, pos, a, rest);
+    split(rest, len, b, c);
+    release(b);
+    m_root = merge(merge(a, build(text.data(), text.length())), c);
+
+    // Splits leave short pieces behind; once they dominate, re-chunk the tape.
+    if (m_pieces > 2 * (size() / kPieceSize) + 64) {
+        std::string all = str();
+        release(m_root);
+        m_nodes.clear();
+        m_free.clear();
+        m_root = build(all.data(), all.length());
+    }
+}
+
+void RopeTape::forEachChunk(size_t from, size_t to, const ChunkFn& fn) const {
+    to = std::min(to, size());
+    // In-order walk that skips subtrees outside [from, to).
+    std::vector<std::pair<int, size_t>> stack;  // node, offset of its subtree
+    int t = m_root;
+    size_t base = 0;
+    while (from < to && (t >= 0 || !stack.empty())) {
+        while (t >= 0) {
+            const Node& n = m_nodes[t];
+            size_t own = base + sizeOf(n.left);
+            if (own + n.text.length() <= from) {
+                base = own + n.text.length();
+                t = n.right;
+            } else if (own >= to) {
+                t = n.left;
+            } else {
+                stack.push_back({t, base});
+                t = n.left;
+            }
+        }
+        if (stack.empty()) break;
+        auto [node, nodeBase] = stack.back();
+        stack.pop_back();
+        const Node& n = m_nodes[node];
+        size_t own = nodeBase + sizeOf(n.left);
+        size_t lo = std::max(from, own);
+        size_t hi = std::min(to, own + n.text.length());
+        if (lo < hi && !fn(n.text.data() + (lo - own), hi - lo, lo)) return;
+        from = std::max(from, hi);
+        base = own + n.text.length();
+        t = n.right;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "TapeStorage.h"
+
+// Tape kept as an implicit treap of short text pieces: a rewrite splits and
+// merges O(log n) nodes and never touches the symbols around it.
+class RopeTape : public TapeStorage {
+    struct Node {
+        std::string text;
+        uint32_t priority = 0;
+        int left = -1;
+        int right = -1;
+        size_t size = 0;  // symbols in the whole subtree
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_free;
+    int m_root = -1;
+    size_t m_pieces = 0;
+    uint32_t m_seed = 0x9E3779B9u;
+
+    size_t sizeOf(int t) const { return t < 0 ? 0 : m_nodes[t].size; }
+    void update(int t);
+    int newNode(std::string text, uint32_t priority);
+    int newNode(std::string text);
+    void release(int t);
+    void split(int t, size_t k, int& a, int& b);
+    int merge(int a, int b);
+    int build(const char* data, size_t n);
+
+public:
+    explicit RopeTape(const std::string& data);
+
+    std::unique_ptr<TapeStorage> clone() const override;
+    size_t size() const override { return sizeOf(m_root); }
+    char at(size_t i) const override;
+    void replace(size_t pos, size_t len, const std::string& text) override;
+    void forEachChunk(size_t from, size_t to, const ChunkFn& fn) const override;
+};
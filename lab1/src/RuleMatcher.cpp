@@ -0,0 +1,81 @@
+#include "RuleMatcher.h"
+#include <algorithm>
+#include <queue>
+
+RuleMatcher::RuleMatcher(const std::vector<Rule>& rules) : m_rules(rules) {
+    for (const auto& rule : rules)
+        for (unsigned char c : rule.pattern)
+            if (!m_classOf[c]) m_classOf[c] = static_cast<uint16_t>(m_classes++);
+
+    // Trie over symbol classes; missing edges are 0 until the BFS below.
+    m_next.assign(m_classes, 0);
+    std::vector<std::vector<uint32_t>> terminal(1);
+    for (size_t r = 0; r < rules.size(); ++r) {
+        const std::string& p = rules[r].pattern;
+        m_lengths.push_back(p.length());
+        m_symbols.emplace_back();
+        for (unsigned char c : p) m_symbols.back().set(c);
+        m_maxLength = std::max(m_maxLength, p.length());
+        uint32_t s = 0;
+        for (unsigned char c : p) {
+            uint32_t& edge = m_next[s * m_classes + m_classOf[c]];
+            if (!edge) {
+                edge = static_cast<uint32_t>(terminal.size());
+                terminal.emplace_back();
+                m_next.resize(m_next.size() + m_classes, 0);
+            }
+            s = m_next[s * m_classes + m_classOf[c]];
+        }
+        if (!p.empty()) terminal[s].push_back(static_cast<uint32_t>(r));
+    }
+
+    m_outBegin.reserve(terminal.size() + 1);
+    for (const auto& list : terminal) {
+        m_outBegin.push_back(static_cast<uint32_t>(m_outRules.size()));
+        m_outRules.insert(m_outRules.end(), list.begin(), list.end());
+    }
+    m_outBegin.push_back(static_cast<uint32_t>(m_outRules.size()));
+
+    // Complete the goto function into a DFA and link each state to its
+    // nearest suffix state that reports rules.
+    std::vector<uint32_t> fail(terminal.size(), 0);
+    m_dictLink.assign(terminal.size(), 0);
+    std::queue<uint32_t> queue;
+    for (size_t c = 0; c < m_classes; ++c)
+        if (uint32_t t = m_next[c]) queue.push(t);
+    while (!queue.empty()) {
+        uint32_t s = queue.front();
+        queue.pop();
+        uint32_t f = fail[s];
+        m_dictLink[s] = terminal[f].empty() ? m_dictLink[f] : f;
+        for (size_t c = 0; c < m_classes; ++c) {
+            uint32_t& edge = m_next[s * m_classes + c];
+            uint32_t target = m_next[f * m_classes + c];
+            if (edge) {
+                fail[edge] = target;
+                queue.push(edge);
+            } else {
+                edge = target;
+            }
+        }
+    }
+}
+
+uint32_t RuleMatcher::scan(uint32_t state, const char* text, size_t n, size_t base,
+                           std::vector<size_t>& leftmost, size_t& missing) const {
+    if (m_lengths.empty()) return state;
+    for (size_t i = 0; i < n && missing; ++i) {
+        state = m_next[state * m_classes + m_classOf[static_cast<unsigned char>(text[i])]];
+        uint32_t t = m_outBegin[state] != m_outBegin[state + 1] ? state : m_dictLink[state];
+        for (; t; t = m_dictLink[t]) {
+            for (uint32_t k = m_outBegin[t]; k < m_outBegin[t + 1]; ++k) {
+                uint32_t r = m_outRules[k];
+                if (leftmost[r] == npos) {
+                    leftmost[r] = base + i + 1 - m_lengths[r];
+                    --missing;
+                }
+            }
+        }
+    }
+    return state;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Rule.h"
+
+// Aho-Corasick automaton compiled from the patterns of a rule list.
+// Rule priority is the list order: a lower index wins. A compiled matcher
+// is immutable and may be shared by machines running on other threads.
+class RuleMatcher {
+    std::vector<Rule> m_rules;
+    std::array<uint16_t, 256> m_classOf{};  // byte -> symbol class, 0 = not in any pattern
+    size_t m_classes = 1;
+    std::vector<uint32_t> m_next;           // state * m_classes + class -> state
+    std::vector<uint32_t> m_outBegin;       // rules ending exactly in state:
+    std::vector<uint32_t> m_outRules;       //   m_outRules[m_outBegin[s] .. m_outBegin[s + 1])
+    std::vector<uint32_t> m_dictLink;       // nearest proper suffix state with outputs, 0 = none
+    std::vector<size_t> m_lengths;          // pattern length per rule
+    std::vector<std::bitset<256>> m_symbols;  // symbols each pattern needs on the tape
+    size_t m_maxLength = 0;
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    RuleMatcher() = default;
+    explicit RuleMatcher(const std::vector<Rule>& rules);
+
+    const std::vector<Rule>& rules() const { return m_rules; }
+    size_t ruleCount() const { return m_lengths.size(); }
+    size_t length(size_t rule) const { return m_lengths[rule]; }
+    size_t maxLength() const { return m_maxLength; }
+    const std::bitset<256>& symbols(size_t rule) const { return m_symbols[rule]; }
+
+    // Runs the automaton over text[0, n) from state and returns the state reached,
+    // so a long tape can be fed in pieces. text[0] sits at tape offset base.
+    // Every still-npos slot of leftmost receives the start of that rule's first
+    // occurrence; missing counts the npos slots and stops the scan at zero.
+    uint32_t scan(uint32_t state, const char* text, size_t n, size_t base,
+                  std::vector<size_t>& leftmost, size_t& missing) const;
+};
@@ -0,0 +1,27 @@
+#pragma once
+// Internal to the SIMD kernels (SimdSearch.cpp, RectSet.cpp): x86 detection,
+// per-function target attributes and bit scanning. Not a public header.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define POST_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define POST_TARGET_SSE2
+#define POST_TARGET_AVX2
+#else
+#define POST_TARGET_SSE2 __attribute__((target("sse2")))
+#define POST_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Index of the lowest set bit; mask must not be zero.
+#ifdef _MSC_VER
+inline int lowestBit(unsigned mask) {
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+}
+#else
+inline int lowestBit(unsigned mask) { return __builtin_ctz(mask); }
+#endif
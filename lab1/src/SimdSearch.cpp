@@ -0,0 +1,125 @@
+#include "SimdSearch.h"
+#include <cstring>
+#include "SimdCommon.h"
+
+namespace {
+
+const size_t npos = static_cast<size_t>(-1);
+
+size_t scalarFind(const char* hay, size_t n, const char* needle, size_t m, size_t from) {
+    if (m > n) return npos;
+    const char first = needle[0];
+    for (size_t i = from; i + m <= n; ++i) {
+        const void* hit = std::memchr(hay + i, first, n - m + 1 - i);
+        if (!hit) return npos;
+        i = static_cast<const char*>(hit) - hay;
+        if (std::memcmp(hay + i + 1, needle + 1, m - 1) == 0) return i;
+    }
+    return npos;
+}
+
+#ifdef POST_SIMD_X86
+
+POST_TARGET_SSE2
+size_t sse2Find(const char* hay, size_t n, const char* needle, size_t m) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + m - 1));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        while (mask) {
+            int bit = lowestBit(mask);
+            if (std::memcmp(hay + i + bit + 1, needle + 1, m > 2 ? m - 2 : 0) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return scalarFind(hay, n, needle, m, i);
+}
+
+POST_TARGET_AVX2
+size_t avx2Find(const char* hay, size_t n, const char* needle, size_t m) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        while (mask) {
+            int bit = lowestBit(mask);
+            if (std::memcmp(hay + i + bit + 1, needle + 1, m > 2 ? m - 2 : 0) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    size_t rest = sse2Find(hay + i, n - i, needle, m);
+    return rest == npos ? npos : i + rest;
+}
+
+bool cpuHasSse2() {
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+SimdLevel detect() {
+#ifdef POST_SIMD_X86
+    if (cpuHasAvx2()) return SimdLevel::AVX2;
+    if (cpuHasSse2()) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+const SimdLevel kDetected = detect();
+
+}
+
+SimdLevel simdLevel() {
+    return kDetected;
+}
+
+size_t simdFind(const char* hay, size_t n, const char* needle, size_t m) {
+    return simdFind(hay, n, needle, m, kDetected);
+}
+
+size_t simdFind(const char* hay, size_t n, const char* needle, size_t m, SimdLevel level) {
+    if (m == 0) return 0;
+    if (m > n) return npos;
+    if (m == 1) {
+        const void* hit = std::memchr(hay, needle[0], n);
+        return hit ? static_cast<const char*>(hit) - hay : npos;
+    }
+#ifdef POST_SIMD_X86
+    if (level == SimdLevel::AVX2) return avx2Find(hay, n, needle, m);
+    if (level == SimdLevel::SSE2) return sse2Find(hay, n, needle, m);
+#else
+    (void)level;
+#endif
+    return scalarFind(hay, n, needle, m, 0);
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+// Best kernel this CPU supports, detected once at startup.
+SimdLevel simdLevel();
+
+// Leftmost occurrence of needle[0, m) in hay[0, n), or npos. Candidates are
+// filtered by comparing the first and the last needle byte over a whole
+// vector of positions, which suits the short patterns of Post rules.
+size_t simdFind(const char* hay, size_t n, const char* needle, size_t m);
+size_t simdFind(const char* hay, size_t n, const char* needle, size_t m, SimdLevel level);
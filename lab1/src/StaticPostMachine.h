@@ -0,0 +1,155 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// String literal usable as a template argument: StaticRule<"1+", "+1">.
+template<size_t N>
+struct FixedString {
+    char data[N]{};
+
+    constexpr FixedString(const char (&text)[N]) { std::copy_n(text, N, data); }
+    static constexpr size_t size() { return N - 1; }
+    constexpr std::string_view view() const { return {data, N - 1}; }
+};
+
+// One rewrite rule known at compile time. The pattern length is a constant,
+// so comparing a candidate position compiles to a fixed run of byte compares.
+template<FixedString Pattern, FixedString Replace, bool MoveRight = true>
+struct StaticRule {
+    static_assert(Pattern.size() > 0, "a rule pattern must not be empty");
+
+    static constexpr size_t length = Pattern.size();
+    static constexpr std::string_view pattern = Pattern.view();
+    static constexpr std::string_view replace = Replace.view();
+    static constexpr bool moveRight = MoveRight;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Leftmost occurrence starting in [from, to), or npos.
+    static size_t find(const std::string& tape, size_t from, size_t to) {
+        if (tape.length() < length) return npos;
+        to = std::min(to, tape.length() - length + 1);
+        const char* data = tape.data();
+        while (from < to) {
+            const void* hit = std::memchr(data + from, Pattern.data[0], to - from);
+            if (!hit) return npos;
+            size_t i = static_cast<const char*>(hit) - data;
+            if (matchTail(data + i, std::make_index_sequence<length - 1>{})) return i;
+            from = i + 1;
+        }
+        return npos;
+    }
+
+private:
+    template<size_t... I>
+    static bool matchTail(const char* text, std::index_sequence<I...>) {
+        return ((text[I + 1] == Pattern.data[I + 1]) && ...);
+    }
+};
+
+// PostMachine whose rules are fixed at compile time:
+//
+//   StaticPostMachine<StaticRule<"1+", "+1">, StaticRule<"+", "", false>> pm("11+111=");
+//
+// Semantics match PostMachine: the first rule in the list that occurs on the
+// tape is applied at its leftmost occurrence. The tape is a plain string and
+// each rule's leftmost occurrence is cached and updated around every rewrite,
+// with one search loop per rule generated for its pattern.
+template<class... Rules>
+class StaticPostMachine {
+    static_assert(sizeof...(Rules) > 0, "a StaticPostMachine needs at least one rule");
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    std::string m_tape = "_";
+    size_t m_pos = 0;
+    size_t m_steps = 0;
+    std::array<size_t, sizeof...(Rules)> m_leftmost{};
+    bool m_leftmostValid = false;
+
+    template<size_t... I>
+    void rescanAll(std::index_sequence<I...>) {
+        ((m_leftmost[I] = Rules::find(m_tape, 0, npos)), ...);
+        m_leftmostValid = true;
+    }
+
+    // Same reasoning as PostMachine::rescanAround(): only an occurrence that
+    // overlaps the edited range can be new, everything else keeps or shifts.
+    template<class Rule>
+    void update(size_t& found, size_t pos, size_t removed, size_t inserted) {
+        if (found != npos && found + Rule::length <= pos) return;
+        size_t start = pos >= Rule::length - 1 ? pos - (Rule::length - 1) : 0;
+        if (found != npos && found < pos + removed) {
+            found = Rule::find(m_tape, start, npos);
+            return;
+        }
+        size_t near = Rule::find(m_tape, start, pos + inserted);
+        if (near != npos) found = near;
+        else if (found != npos) found = found - removed + inserted;
+    }
+
+    // Rewrites m_tape[pos, pos + Rule::length) with Rule::replace. Both
+    // lengths are known here, so the tail is shifted by hand instead of
+    // std::string::replace, whose inlined overlap handling trips a bogus
+    // -Wrestrict in GCC 12 (GCC bug 105329).
+    template<class Rule>
+    void rewrite(size_t pos) {
+        constexpr size_t from = Rule::length;
+        constexpr size_t to = Rule::replace.length();
+        if constexpr (to > from) {
+            size_t old = m_tape.length();
+            m_tape.resize(old + (to - from));
+            std::copy_backward(m_tape.begin() + pos + from, m_tape.begin() + old, m_tape.end());
+        } else if constexpr (to < from) {
+            m_tape.erase(pos + to, from - to);
+        }
+        std::copy(Rule::replace.begin(), Rule::replace.end(), m_tape.begin() + pos);
+    }
+
+    template<class Rule>
+    bool apply(size_t pos) {
+        rewrite<Rule>(pos);
+        size_t k = 0;
+        (update<Rules>(m_leftmost[k++], pos, Rule::length, Rule::replace.length()), ...);
+        m_pos = Rule::moveRight ? pos + Rule::replace.length() : pos;
+        if (m_pos > m_tape.length()) m_pos = m_tape.length();
+        ++m_steps;
+        return true;
+    }
+
+    template<size_t... I>
+    bool applyFirst(std::index_sequence<I...>) {
+        return ((m_leftmost[I] != npos && apply<Rules>(m_leftmost[I])) || ...);
+    }
+
+public:
+    static constexpr size_t ruleCount = sizeof...(Rules);
+
+    StaticPostMachine() = default;
+    explicit StaticPostMachine(const std::string& tape) { reset(tape); }
+
+    void reset(const std::string& tape) {
+        m_tape = tape.empty() ? "_" : tape;
+        m_pos = 0;
+        m_steps = 0;
+        m_leftmostValid = false;
+    }
+
+    bool step() {
+        if (!m_leftmostValid) rescanAll(std::index_sequence_for<Rules...>{});
+        return applyFirst(std::index_sequence_for<Rules...>{});
+    }
+
+    void run(int maxSteps = -1) {
+        int steps = 0;
+        while ((maxSteps < 0 || steps < maxSteps) && step())
+            ++steps;
+    }
+
+    const std::string& tape() const { return m_tape; }
+    size_t tapeLength() const { return m_tape.length(); }
+    size_t pos() const { return m_pos; }
+    size_t steps() const { return m_steps; }
+};
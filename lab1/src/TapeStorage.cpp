@@ -0,0 +1,96 @@
+#include "TapeStorage.h"
+#include <algorithm>
+#include "FileTape.h"
+#include "GapBufferTape.h"
+#include "RleTape.h"
+#include "RopeTape.h"
+#include "SimdSearch.h"
+
+size_t TapeStorage::find(const std::string& pattern, size_t from) const {
+    return findIn(pattern, from, size());
+}
+
+size_t TapeStorage::findIn(const std::string& pattern, size_t from, size_t to) const {
+    size_t m = pattern.length();
+    to = std::min(to, size());
+    if (m == 0 || from >= to) return npos;
+    size_t limit = std::min(size(), to + m - 1);
+
+    // Occurrences may straddle chunk borders, so the last m - 1 symbols seen
+    // are carried over and searched together with the head of the next chunk.
+    size_t result = npos;
+    std::string carry;
+    forEachChunk(from, limit, [&](const char* data, size_t n, size_t offset) {
+        if (!carry.empty()) {
+            std::string joined = carry;
+            joined.append(data, std::min(n, m - 1));
+            size_t hit = joined.find(pattern);
+            if (hit != std::string::npos) {
+                result = offset - carry.length() + hit;
+                return false;
+            }
+        }
+        size_t hit = simdFind(data, n, pattern.data(), m);
+        if (hit != npos) {
+            result = offset + hit;
+            return false;
+        }
+        if (n >= m - 1) {
+            carry.assign(data + n - (m - 1), m - 1);
+        } else {
+            carry.append(data, n);
+            if (carry.length() > m - 1) carry.erase(0, carry.length() - (m - 1));
+        }
+        return true;
+    });
+    return result;
+}
+
+void TapeStorage::countSymbols(std::array<size_t, 256>& counts) const {
+    forEachChunk(0, size(), [&](const char* data, size_t n, size_t) {
+        for (size_t i = 0; i < n; ++i) ++counts[static_cast<unsigned char>(data[i])];
+        return true;
+    });
+}
+
+std::string TapeStorage::copy(size_t pos, size_t len) const {
+    std::string out;
+    out.reserve(len);
+    forEachChunk(pos, pos + len, [&](const char* data, size_t n, size_t) {
+        out.append(data, n);
+        return true;
+    });
+    return out;
+}
+
+std::unique_ptr<TapeStorage> StringTape::clone() const {
+    return std::make_unique<StringTape>(m_data);
+}
+
+void StringTape::replace(size_t pos, size_t len, const std::string& text) {
+    m_data.replace(pos, len, text);
+}
+
+void StringTape::forEachChunk(size_t from, size_t to, const ChunkFn& fn) const {
+    to = std::min(to, m_data.length());
+    if (from < to) fn(m_data.data() + from, to - from, from);
+}
+
+size_t StringTape::find(const std::string& pattern, size_t from) const {
+    if (pattern.empty() || from >= m_data.length()) return npos;
+    size_t hit = simdFind(m_data.data() + from, m_data.length() - from, pattern.data(), pattern.length());
+    return hit == npos ? npos : from + hit;
+}
+
+std::unique_ptr<TapeStorage> makeTape(TapeBackend backend, const std::string& data) {
+    switch (backend) {
+    case TapeBackend::GapBuffer: return std::make_unique<GapBufferTape>(data);
+    case TapeBackend::Rope: return std::make_unique<RopeTape>(data);
+    case TapeBackend::RunLength: return std::make_unique<RleTape>(data);
+    case TapeBackend::File:
+        // Falls back to memory when no temporary file can be created.
+        if (auto tape = FileTape::fromData(data)) return tape;
+        return std::make_unique<StringTape>(data);
+    default: return std::make_unique<StringTape>(data);
+    }
+}
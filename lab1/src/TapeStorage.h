@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+
+enum class TapeBackend { String, GapBuffer, Rope, RunLength, File };
+
+// Storage behind a PostMachine tape. Backends differ in how they lay the
+// symbols out; all of them present the tape as consecutive chunks.
+class TapeStorage {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // fn(data, n, offset) receives tape[offset, offset + n); returning false stops.
+    using ChunkFn = std::function<bool(const char* data, size_t n, size_t offset)>;
+
+    virtual ~TapeStorage() = default;
+    virtual std::unique_ptr<TapeStorage> clone() const = 0;
+
+    virtual size_t size() const = 0;
+    virtual char at(size_t i) const = 0;
+    virtual void replace(size_t pos, size_t len, const std::string& text) = 0;
+    virtual void forEachChunk(size_t from, size_t to, const ChunkFn& fn) const = 0;
+
+    // Backing string when the tape is stored contiguously, nullptr otherwise.
+    virtual const std::string* contiguous() const { return nullptr; }
+
+    // Compressed backends answer find() without expanding the tape, so full
+    // rescans should go through it rather than through forEachChunk().
+    virtual bool compressed() const { return false; }
+
+    // Leftmost occurrence of pattern starting at or after from, or npos.
+    virtual size_t find(const std::string& pattern, size_t from) const;
+
+    // Leftmost occurrence starting in [from, to), reading through forEachChunk()
+    // only, so uncompressed tapes may be searched from several threads at once.
+    size_t findIn(const std::string& pattern, size_t from, size_t to) const;
+
+    // Adds the number of occurrences of every symbol to counts.
+    virtual void countSymbols(std::array<size_t, 256>& counts) const;
+
+    std::string copy(size_t pos, size_t len) const;
+    std::string str() const { return copy(0, size()); }
+};
+
+class StringTape : public TapeStorage {
+    std::string m_data;
+
+public:
+    explicit StringTape(std::string data) : m_data(std::move(data)) {}
+
+    std::unique_ptr<TapeStorage> clone() const override;
+    size_t size() const override { return m_data.length(); }
+    char at(size_t i) const override { return m_data[i]; }
+    void replace(size_t pos, size_t len, const std::string& text) override;
+    void forEachChunk(size_t from, size_t to, const ChunkFn& fn) const override;
+    const std::string* contiguous() const override { return &m_data; }
+    size_t find(const std::string& pattern, size_t from) const override;
+};
+
+std::unique_ptr<TapeStorage> makeTape(TapeBackend backend, const std::string& data);
@@ -0,0 +1,107 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace {
+thread_local const ThreadPool* t_pool = nullptr;
+thread_local size_t t_index = 0;
+const size_t kNotWorker = static_cast<size_t>(-1);
+}
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < threads; ++i) m_queues.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < threads; ++i) m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_threads) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t target = t_pool == this ? t_index : m_nextQueue++ % m_queues.size();
+    {
+        std::lock_guard<std::mutex> lock(m_queues[target]->mutex);
+        m_queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_queued;
+    }
+    m_wake.notify_one();
+}
+
+// Runs one task: the newest of our own queue, else the oldest of another.
+bool ThreadPool::runOne(size_t self) {
+    std::function<void()> task;
+    if (self != kNotWorker) {
+        Queue& own = *m_queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    for (size_t k = 1; !task && k <= m_queues.size(); ++k) {
+        Queue& victim = *m_queues[(self == kNotWorker ? k : self + k) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+    --m_queued;
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t self) {
+    t_pool = this;
+    t_index = self;
+    while (true) {
+        if (runOne(self)) continue;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this] { return m_stop || m_queued > 0; });
+        if (m_stop && m_queued == 0) return;
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, size_t grain,
+                             const std::function<void(size_t, size_t)>& fn) {
+    if (n == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    std::atomic<size_t> remaining((n + grain - 1) / grain);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    for (size_t begin = 0; begin < n; begin += grain) {
+        size_t end = std::min(n, begin + grain);
+        submit([&, begin, end] {
+            try {
+                fn(begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+            }
+            if (--remaining == 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done.notify_all();
+            }
+        });
+    }
+
+    size_t self = t_pool == this ? t_index : kNotWorker;
+    while (remaining > 0) {
+        if (runOne(self)) continue;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait_for(lock, std::chrono::milliseconds(1), [&] { return remaining == 0; });
+    }
+    if (error) std::rethrow_exception(error);
+}
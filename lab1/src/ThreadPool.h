@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers, each with its own task deque. A worker takes its
+// newest task first and, when idle, steals the oldest task of another one.
+class ThreadPool {
+    struct Queue {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::atomic<size_t> m_queued{0};
+    std::atomic<size_t> m_nextQueue{0};
+    bool m_stop = false;
+
+    bool runOne(size_t self);
+    void workerLoop(size_t self);
+
+public:
+    explicit ThreadPool(size_t threads = 0);  // 0 = one per hardware thread
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    size_t size() const { return m_threads.size(); }
+
+    void submit(std::function<void()> task);
+
+    // Calls fn(begin, end) over [0, n) in slices of about grain items and
+    // returns when all are done. The calling thread runs tasks meanwhile,
+    // so it is safe to call from inside a task.
+    void parallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t)>& fn);
+};
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include "PostBatch.h"
+
+TEST(ThreadPool, ParallelForCoversRange) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+    pool.parallelFor(hits.size(), 7, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) ++hits[i];
+    });
+    for (const auto& h : hits) EXPECT_EQ(h.load(), 1);
+}
+
+TEST(ThreadPool, NestedParallelFor) {
+    ThreadPool pool(2);
+    std::atomic<int> total(0);
+    pool.parallelFor(8, 1, [&](size_t, size_t) {
+        pool.parallelFor(8, 1, [&](size_t, size_t) { ++total; });
+    });
+    EXPECT_EQ(total.load(), 64);
+}
+
+TEST(PostBatch, MatchesSerialRuns) {
+    PostMachine prototype;
+    prototype.addRule("1+", "+1");
+    prototype.addRule("+", "", false);
+
+    std::vector<BatchJob> jobs;
+    for (int i = 0; i < 200; ++i)
+        jobs.push_back({std::string(i % 13, '1') + "+" + std::string(i % 7, '1'), i % 3 == 0 ? 2 : -1});
+
+    PostBatch batch(prototype);
+    std::vector<BatchResult> results = batch.run(jobs, 4);
+    ASSERT_EQ(results.size(), jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        PostMachine pm(jobs[i].tape);
+        pm.addRule("1+", "+1");
+        pm.addRule("+", "", false);
+        pm.run(jobs[i].maxSteps);
+        EXPECT_EQ(results[i].tape, pm.tape());
+        EXPECT_EQ(results[i].pos, pm.pos());
+        EXPECT_EQ(results[i].steps, pm.steps());
+    }
+}
+
+TEST(PostMachine, ParallelSearchAgreesWithSerial) {
+    std::mt19937 rng(11);
+    std::string tape(60000, 'a');
+    for (char& c : tape) c = "abc"[rng() % 3];
+    tape[59990] = 'd';
+
+    ThreadPool pool(3);
+    for (TapeBackend backend : {TapeBackend::String, TapeBackend::Rope, TapeBackend::File}) {
+        PostMachine serial(tape);
+        PostMachine parallel(tape, backend);
+        parallel.setParallelSearch(&pool, 1);
+        for (PostMachine* pm : {&serial, &parallel}) {
+            pm->addRule("cd", "x");
+            pm->addRule("abcab", "c");
+            pm->addRule("bb", "a");
+            pm->addRule("ca", "ac");
+            pm->run(500);
+        }
+        EXPECT_EQ(parallel.tape(), serial.tape());
+        EXPECT_EQ(parallel.pos(), serial.pos());
+        EXPECT_EQ(parallel.steps(), serial.steps());
+    }
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include "PostMachine.h"
+
+namespace {
+
+std::string tempPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+}
+
+TEST(Checkpoint, RoundTrip) {
+    std::string path = tempPath("pm_roundtrip.ckpt");
+    PostMachine pm("111+11", TapeBackend::Rope);
+    pm.addRule("1+", "+1");
+    pm.addRule("+", "", false);
+    pm.run(2);
+    ASSERT_TRUE(pm.saveCheckpoint(path));
+
+    PostMachine restored;
+    ASSERT_TRUE(restored.loadCheckpoint(path));
+    EXPECT_EQ(restored.tape(), pm.tape());
+    EXPECT_EQ(restored.pos(), pm.pos());
+    EXPECT_EQ(restored.steps(), 2);
+    EXPECT_EQ(restored.ruleCount(), 2);
+    EXPECT_EQ(restored.backend(), TapeBackend::Rope);
+
+    pm.run();
+    restored.run();
+    EXPECT_EQ(restored.tape(), pm.tape());
+    EXPECT_EQ(restored.steps(), pm.steps());
+    std::remove(path.c_str());
+}
+
+TEST(Checkpoint, ResumeAfterPeriodicSaves) {
+    std::string path = tempPath("pm_periodic.ckpt");
+    PostMachine pm(std::string(100, 'a'));
+    pm.addRule("a", "b");
+    ASSERT_TRUE(pm.runWithCheckpoints(37, path, 10));
+
+    PostMachine resumed;
+    ASSERT_TRUE(resumed.loadCheckpoint(path));
+    EXPECT_EQ(resumed.steps(), 37);
+    resumed.run();
+    EXPECT_EQ(resumed.tape(), std::string(100, 'b'));
+    EXPECT_EQ(resumed.steps(), 100);
+    std::remove(path.c_str());
+}
+
+TEST(Checkpoint, FileBackendReadsTapeFromCheckpoint) {
+    std::string path = tempPath("pm_file.ckpt");
+    PostMachine pm(std::string(300, 'a'), TapeBackend::File);
+    pm.addRule("a", "b");
+    ASSERT_TRUE(pm.runWithCheckpoints(100, path, 40));
+
+    PostMachine resumed;
+    ASSERT_TRUE(resumed.loadCheckpoint(path));
+    EXPECT_EQ(resumed.backend(), TapeBackend::File);
+    EXPECT_EQ(resumed.tape(), std::string(100, 'b') + std::string(200, 'a'));
+    // Saving over the checkpoint the tape is mapped from.
+    ASSERT_TRUE(resumed.runWithCheckpoints(-1, path, 50));
+    EXPECT_EQ(resumed.tape(), std::string(300, 'b'));
+
+    PostMachine again;
+    ASSERT_TRUE(again.loadCheckpoint(path));
+    EXPECT_EQ(again.tape(), std::string(300, 'b'));
+    EXPECT_EQ(again.steps(), 300);
+    std::remove(path.c_str());
+}
+
+TEST(Checkpoint, FailedSaveRemovesTempFile) {
+    // A non-empty directory in the way makes the final rename fail.
+    std::string path = tempPath("pm_blocked.ckpt");
+    std::filesystem::create_directories(path + "/inside");
+    PostMachine pm("111");
+    EXPECT_FALSE(pm.saveCheckpoint(path));
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+    std::filesystem::remove_all(path);
+}
+
+TEST(Checkpoint, RejectsGarbage) {
+    std::string path = tempPath("pm_garbage.ckpt");
+    {
+        std::ofstream os(path, std::ios::binary);
+        os << "PMCK\x01";
+    }
+    PostMachine pm("keep");
+    EXPECT_FALSE(pm.loadCheckpoint(path));
+    EXPECT_FALSE(pm.loadCheckpoint(tempPath("pm_missing.ckpt")));
+    EXPECT_EQ(pm.tape(), "keep");
+    std::remove(path.c_str());
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include "RectCoverage.h"
+
+namespace {
+
+// Depth of every unit cell of a small grid, by brute force.
+std::vector<int> cellDepths(const std::vector<Rect2D>& rects, int side) {
+    std::vector<int> depth(side * side, 0);
+    for (const Rect2D& r : rects)
+        for (int x = r.left(); x < r.right(); ++x)
+            for (int y = r.top(); y < r.bottom(); ++y) ++depth[x * side + y];
+    return depth;
+}
+
+std::vector<Rect2D> randomRects(size_t n, int side, std::mt19937& rng) {
+    std::uniform_int_distribution<int> coord(0, side);
+    std::vector<Rect2D> rects;
+    for (size_t i = 0; i < n; ++i) rects.emplace_back(coord(rng), coord(rng), coord(rng), coord(rng));
+    return rects;
+}
+
+int64_t shoelace(const Polygon& p) {
+    int64_t twice = 0;
+    for (size_t i = 0; i < p.size(); ++i) {
+        const OutlinePoint& a = p[i];
+        const OutlinePoint& b = p[(i + 1) % p.size()];
+        twice += int64_t(a.x) * b.y - int64_t(b.x) * a.y;
+    }
+    return twice / 2;
+}
+
+}
+
+TEST(RectCoverage, MatchesCellCount) {
+    std::mt19937 rng(31);
+    ThreadPool pool(3);
+    for (int trial = 0; trial < 20; ++trial) {
+        std::vector<Rect2D> rects = randomRects(1 + rng() % 40, 60, rng);
+        std::vector<int> depth = cellDepths(rects, 60);
+        std::vector<uint64_t> exact(5, 0);
+        for (int d : depth) ++exact[std::min(d, 4)];
+
+        uint64_t covered = depth.size() - std::count(depth.begin(), depth.end(), 0);
+        EXPECT_EQ(unionArea(rects), covered);
+        EXPECT_EQ(unionArea(rects, pool), covered);
+        uint64_t twice = std::count_if(depth.begin(), depth.end(), [](int d) { return d >= 2; });
+        EXPECT_EQ(coveredAtLeast(rects, 2), twice);
+        EXPECT_EQ(coveredAtLeast(rects, 2, pool), twice);
+
+        std::vector<uint64_t> histogram = depthHistogram(rects, 4, pool);
+        ASSERT_EQ(histogram.size(), 5u);
+        for (int d = 1; d <= 4; ++d) EXPECT_EQ(histogram[d], exact[d]);
+        EXPECT_EQ(histogram, depthHistogram(rects, 4));
+    }
+}
+
+TEST(RectCoverage, HistogramCountsUncoveredBox) {
+    std::vector<Rect2D> rects{Rect2D(0, 0, 2, 2), Rect2D(3, 0, 4, 2), Rect2D(1, 1, 2, 2)};
+    std::vector<uint64_t> histogram = depthHistogram(rects, 2);
+    EXPECT_EQ(histogram, (std::vector<uint64_t>{2, 5, 1}));
+}
+
+TEST(RectCoverage, OutlineOfOverlappingPair) {
+    std::vector<Polygon> outline = unionOutline({Rect2D(0, 0, 2, 2), Rect2D(1, 1, 3, 3)});
+    ASSERT_EQ(outline.size(), 1u);
+    EXPECT_EQ(outline[0].size(), 8u);
+    EXPECT_EQ(shoelace(outline[0]), 7);
+}
+
+TEST(RectCoverage, OutlineWithHoleAndCornerTouch) {
+    std::vector<Rect2D> frame{Rect2D(0, 0, 5, 1), Rect2D(0, 4, 5, 5), Rect2D(0, 0, 1, 5), Rect2D(4, 0, 5, 5),
+                              Rect2D(5, 5, 6, 6)};
+    std::vector<Polygon> outline = unionOutline(frame);
+    ASSERT_EQ(outline.size(), 3u);
+    std::vector<int64_t> areas;
+    for (const Polygon& p : outline) areas.push_back(shoelace(p));
+    std::sort(areas.begin(), areas.end());
+    EXPECT_EQ(areas, (std::vector<int64_t>{-9, 1, 25}));
+}
+
+TEST(RectCoverage, OutlineAreaMatchesUnion) {
+    std::mt19937 rng(32);
+    for (int trial = 0; trial < 30; ++trial) {
+        std::vector<Rect2D> rects = randomRects(1 + rng() % 30, 50, rng);
+        int64_t total = 0;
+        for (const Polygon& p : unionOutline(rects)) {
+            total += shoelace(p);
+            for (size_t i = 0; i < p.size(); ++i) {
+                const OutlinePoint& a = p[i];
+                const OutlinePoint& b = p[(i + 1) % p.size()];
+                EXPECT_TRUE(a.x == b.x || a.y == b.y);
+            }
+        }
+        EXPECT_EQ(uint64_t(total), unionArea(rects));
+    }
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <mutex>
+#include <random>
+#include <tuple>
+#include "RectJoin.h"
+
+namespace {
+
+using Pair = std::tuple<size_t, size_t, int, int, int, int>;
+
+std::vector<Rect2D> randomRects(size_t n, std::mt19937& rng) {
+    std::uniform_int_distribution<int> coord(0, 400), size(0, 50);
+    std::vector<Rect2D> rects;
+    for (size_t i = 0; i < n; ++i) {
+        int x = coord(rng), y = coord(rng);
+        rects.emplace_back(x, y, x + size(rng), y + size(rng));
+    }
+    return rects;
+}
+
+Pair pair(size_t i, size_t j, const Rect2D& r) {
+    return {i, j, r.left(), r.top(), r.right(), r.bottom()};
+}
+
+std::vector<Pair> nestedLoop(const std::vector<Rect2D>& a, const std::vector<Rect2D>& b) {
+    std::vector<Pair> out;
+    for (size_t i = 0; i < a.size(); ++i)
+        for (size_t j = 0; j < b.size(); ++j) {
+            Rect2D overlap = a[i] - b[j];
+            if (!(overlap == Rect2D(0, 0, 0, 0))) out.push_back(pair(i, j, overlap));
+        }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+}
+
+TEST(RectJoin, SerialMatchesNestedLoop) {
+    std::mt19937 rng(17);
+    std::vector<Rect2D> a = randomRects(600, rng), b = randomRects(500, rng);
+    std::vector<Pair> pairs;
+    intersectionJoin(a, b, [&](size_t i, size_t j, const Rect2D& r) { pairs.push_back(pair(i, j, r)); });
+    std::sort(pairs.begin(), pairs.end());
+    EXPECT_EQ(pairs, nestedLoop(a, b));
+}
+
+TEST(RectJoin, StripsReportEachPairOnce) {
+    std::mt19937 rng(18);
+    std::vector<Rect2D> a = randomRects(800, rng), b = randomRects(700, rng);
+    a.emplace_back(0, 100, 400, 120);  // crosses every strip
+    b.emplace_back(0, 110, 400, 130);  // and overlaps the one above from the first
+    ThreadPool pool(3);
+    for (size_t strips : {0, 1, 5, 64}) {
+        std::mutex mutex;
+        std::vector<Pair> pairs;
+        intersectionJoin(a, b, [&](size_t i, size_t j, const Rect2D& r) {
+            std::lock_guard<std::mutex> lock(mutex);
+            pairs.push_back(pair(i, j, r));
+        }, pool, strips);
+        std::sort(pairs.begin(), pairs.end());
+        EXPECT_EQ(pairs, nestedLoop(a, b));
+    }
+}
+
+TEST(RectJoin, TouchingRectsDoNotPair) {
+    std::vector<Rect2D> a{Rect2D(0, 0, 10, 10)}, b{Rect2D(10, 0, 20, 10), Rect2D(0, 10, 10, 20)};
+    size_t calls = 0;
+    intersectionJoin(a, b, [&](size_t, size_t, const Rect2D&) { ++calls; });
+    EXPECT_EQ(calls, 0u);
+}
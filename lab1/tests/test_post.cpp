@@ -1,4 +1,8 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include "PostMachine.h"
 
 TEST(PostMachine, DefaultTape) {
@@ -101,3 +105,244 @@ TEST(PostMachine, Deletion) {
     pm.step();
     EXPECT_EQ(pm.tape(), "heo");
 }
+
+TEST(PostMachine, PriorityOverPosition) {
+    PostMachine pm("abcab");
+    pm.addRule("ca", "X");
+    pm.addRule("a", "Y");
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "abXb");
+    EXPECT_EQ(pm.pos(), 3);
+}
+
+TEST(PostMachine, OverlappingPatterns) {
+    PostMachine pm("xabcd");
+    pm.addRule("bcd", "1");
+    pm.addRule("abc", "2");
+    pm.addRule("bc", "3");
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "xa1");
+}
+
+TEST(PostMachine, RulesRecompiledAfterRemove) {
+    PostMachine pm("aab");
+    pm.addRule("a", "x");
+    pm.addRule("b", "y");
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "xab");
+    pm.removeRule(0);
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "xay");
+    pm.addRule("a", "z", false);
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "xzy");
+    EXPECT_EQ(pm.pos(), 1);
+}
+
+TEST(PostMachine, MatchFormedAcrossEdit) {
+    PostMachine pm("aXbab");
+    pm.addRule("ab", "c");
+    pm.addRule("X", "");
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "aXbc");
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "abc");
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "cc");
+    EXPECT_FALSE(pm.step());
+}
+
+TEST(PostMachine, LongTapeRun) {
+    std::string tape(20000, '1');
+    tape += "_";
+    PostMachine pm(tape);
+    pm.addRule("1_", "_");
+    pm.run();
+    EXPECT_EQ(pm.tape(), "_");
+    EXPECT_EQ(pm.pos(), 1);
+}
+
+TEST(PostMachine, BackendsAgree) {
+    for (TapeBackend backend : {TapeBackend::GapBuffer, TapeBackend::Rope, TapeBackend::RunLength,
+                                TapeBackend::File}) {
+        PostMachine plain("11+111=");
+        PostMachine other("11+111=", backend);
+        for (PostMachine* pm : {&plain, &other}) {
+            pm->addRule("1+", "+1");
+            pm->addRule("+", "", false);
+            pm->run();
+        }
+        EXPECT_EQ(other.tape(), plain.tape());
+        EXPECT_EQ(other.pos(), plain.pos());
+    }
+}
+
+TEST(PostMachine, SwitchBackend) {
+    PostMachine pm("aaaa");
+    pm.addRule("aa", "b");
+    pm.step();
+    pm.setBackend(TapeBackend::Rope);
+    pm.step();
+    EXPECT_EQ(pm.tape(), "bb");
+    EXPECT_EQ(pm.backend(), TapeBackend::Rope);
+}
+
+TEST(PostMachine, RunLengthUnaryProgram) {
+    std::string tape = std::string(50000, '1') + "*11=";
+    PostMachine plain(tape);
+    PostMachine rle(tape, TapeBackend::RunLength);
+    for (PostMachine* pm : {&plain, &rle}) {
+        pm->addRule("1*", "*");
+        pm->addRule("*11=", "=", false);
+        pm->run(30000);
+    }
+    EXPECT_EQ(rle.tape(), plain.tape());
+    EXPECT_EQ(rle.pos(), plain.pos());
+}
+
+TEST(PostMachine, OpenTapeFile) {
+    std::string path = ::testing::TempDir() + "pm_tape_file.txt";
+    {
+        std::ofstream os(path, std::ios::binary);
+        os << std::string(3000, '1') << "*11=";
+    }
+    PostMachine plain(std::string(3000, '1') + "*11=");
+    PostMachine mapped;
+    ASSERT_TRUE(mapped.openTapeFile(path));
+    EXPECT_EQ(mapped.backend(), TapeBackend::File);
+    for (PostMachine* pm : {&plain, &mapped}) {
+        pm->addRule("1*", "*");
+        pm->addRule("*11=", "=", false);
+        pm->run();
+    }
+    EXPECT_EQ(mapped.tape(), plain.tape());
+    EXPECT_EQ(mapped.pos(), plain.pos());
+
+    std::ifstream is(path, std::ios::binary);
+    std::string original((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(original, std::string(3000, '1') + "*11=");
+    is.close();
+    std::remove(path.c_str());
+    EXPECT_FALSE(mapped.openTapeFile(path));
+}
+
+TEST(PostMachine, StepCounterAndReset) {
+    PostMachine pm("aaaa");
+    pm.addRule("a", "b");
+    pm.run(3);
+    EXPECT_EQ(pm.steps(), 3);
+    pm.reset("aa");
+    EXPECT_EQ(pm.steps(), 0);
+    EXPECT_EQ(pm.pos(), 0);
+    pm.run();
+    EXPECT_EQ(pm.tape(), "bb");
+    EXPECT_EQ(pm.steps(), 2);
+}
+
+TEST(PostMachine, SharedCompiledRules) {
+    PostMachine source;
+    source.addRule("ab", "c");
+    auto rules = source.compiledRules();
+    PostMachine pm("xabab", rules);
+    EXPECT_EQ(pm.ruleCount(), 1);
+    pm.run();
+    EXPECT_EQ(pm.tape(), "xcc");
+    EXPECT_EQ(pm.compiledRules(), rules);
+}
+
+TEST(PostMachine, DetectsCycle) {
+    PostMachine pm("ab");
+    pm.addRule("ab", "ba");
+    pm.addRule("ba", "ab");
+    RunReport report = pm.runDetectingCycles();
+    EXPECT_EQ(report.status, RunStatus::Cycle);
+    EXPECT_EQ(report.cycleStart, 1);
+    EXPECT_EQ(report.cycleLength, 2);
+}
+
+TEST(PostMachine, DetectsCycleOfRearrangements) {
+    // Every state has the same symbols, length and position; only the order
+    // tells them apart.
+    PostMachine pm("xabcx", TapeBackend::Rope);
+    pm.addRule("abc", "bca", false);
+    pm.addRule("bca", "cab", false);
+    pm.addRule("cab", "abc", false);
+    RunReport report = pm.runDetectingCycles(100);
+    EXPECT_EQ(report.status, RunStatus::Cycle);
+    EXPECT_EQ(report.cycleStart, 1);
+    EXPECT_EQ(report.cycleLength, 3);
+}
+
+TEST(PostMachine, DetectsFixedPoint) {
+    PostMachine pm("xay", TapeBackend::Rope);
+    pm.addRule("a", "a");
+    RunReport report = pm.runDetectingCycles();
+    EXPECT_EQ(report.status, RunStatus::Cycle);
+    EXPECT_EQ(report.cycleStart, 1);
+    EXPECT_EQ(report.cycleLength, 1);
+}
+
+TEST(PostMachine, CycleDetectionHaltsAndLimits) {
+    PostMachine pm("aaaa");
+    pm.addRule("a", "b");
+    RunReport report = pm.runDetectingCycles();
+    EXPECT_EQ(report.status, RunStatus::Halted);
+    EXPECT_EQ(report.steps, 4);
+
+    PostMachine loop("1");
+    loop.addRule("1", "11");
+    report = loop.runDetectingCycles(10);
+    EXPECT_EQ(report.status, RunStatus::StepLimit);
+    EXPECT_EQ(loop.tape(), std::string(11, '1'));
+}
+
+TEST(PostMachine, ProfilerCountsRules) {
+    PostMachine pm("aaab");
+    pm.addRule("b", "c");
+    pm.addRule("a", "d");
+    pm.addRule("zz", "y");
+    RuleProfiler profiler;
+    pm.run(-1, profiler);
+    EXPECT_EQ(pm.tape(), "dddc");
+    EXPECT_EQ(profiler.steps(), 4);
+    ASSERT_EQ(profiler.rules().size(), 3u);
+    EXPECT_EQ(profiler.rules()[0].hits, 1);
+    EXPECT_EQ(profiler.rules()[1].hits, 3);
+    EXPECT_EQ(profiler.rules()[2].hits, 0);
+    // The shared automaton resolves the matches on a plain string tape.
+    EXPECT_GT(profiler.rules()[0].attempts, 0u);
+    EXPECT_GT(profiler.rules()[1].bytesScanned, 0u);
+    EXPECT_EQ(profiler.tapeHighWater(), 4);
+    EXPECT_GT(profiler.sharedBytesScanned(), 0u);
+
+    std::stringstream json, csv;
+    profiler.writeJson(json);
+    profiler.writeCsv(csv);
+    EXPECT_NE(json.str().find("\"steps\":4"), std::string::npos);
+    EXPECT_NE(json.str().find("{\"rule\":2,"), std::string::npos);
+    EXPECT_EQ(csv.str().rfind("rule,attempts,hits,bytes_scanned,nanoseconds,steps,steps_per_second,tape_high_water\n", 0), 0u);
+    std::string rows = csv.str();
+    EXPECT_EQ(std::count(rows.begin(), rows.end(), '\n'), 4);
+}
+
+TEST(PostMachine, ProfilerHighWaterIncludesStartingTape) {
+    PostMachine pm(std::string(100, 'a'));
+    pm.addRule("aa", "a");
+    RuleProfiler profiler;
+    pm.run(-1, profiler);
+    EXPECT_EQ(pm.tape(), "a");
+    EXPECT_EQ(profiler.tapeHighWater(), 100);
+    EXPECT_EQ(profiler.rules()[0].hits, 99);
+}
+
+TEST(PostMachine, MarkerRulesWaitForTheirSymbol) {
+    PostMachine pm("11#", TapeBackend::RunLength);
+    pm.addRule("$1", "1$");
+    pm.addRule("#", "$", false);
+    pm.addRule("1$", "0", false);
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "11$");
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "10");
+    EXPECT_FALSE(pm.step());
+}
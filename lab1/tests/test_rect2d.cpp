@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <cstring>
 #include <sstream>
 #include "Rect2D.h"
 
@@ -105,6 +106,16 @@ TEST(Rect2D, IntersectionEmpty) {
     EXPECT_EQ(i.height(), 0);
 }
 
+TEST(Rect2D, ContainsFollowsHalfOpenRule) {
+    Rect2D r(0, 0, 2, 2);
+    EXPECT_TRUE(r.contains(0, 0));
+    EXPECT_TRUE(r.contains(1, 1));
+    EXPECT_FALSE(r.contains(2, 1));
+    EXPECT_FALSE(r.contains(1, 2));
+    EXPECT_TRUE(r.contains(Rect2D(0, 0, 2, 2)));
+    EXPECT_FALSE(r.contains(Rect2D(1, 1, 3, 2)));
+}
+
 TEST(Rect2D, Equality) {
     Rect2D a(0,0,2,2), b(0,0,2,2), c(0,0,3,3);
     EXPECT_TRUE(a == b);
@@ -119,3 +130,27 @@ TEST(Rect2D, StreamIO) {
     ss >> r2;
     EXPECT_TRUE(r == r2);
 }
+
+TEST(Rect2D, ConstantExpression) {
+    constexpr Rect2D a(4, 4, 0, 0);
+    constexpr Rect2D b = [] {
+        Rect2D r(1, 1, 2, 2);
+        r.move(1, 1);
+        ++r;
+        return r + Rect2D(0, 0, 1, 1);
+    }();
+    static_assert(a.left() == 0 && a.bottom() == 4);
+    static_assert(b == Rect2D(0, 0, 4, 4));
+    static_assert((a - Rect2D(5, 5, 6, 6)) == Rect2D());
+    static_assert(a.contains(3, 3) && !a.contains(4, 4));
+    EXPECT_EQ(b.width(), 4);
+}
+
+TEST(Rect2D, TriviallyCopyable) {
+    EXPECT_TRUE(std::is_trivially_copyable_v<Rect2D>);
+    Rect2D from[2] = {Rect2D(1, 2, 3, 4), Rect2D(5, 6, 7, 8)};
+    Rect2D to[2];
+    std::memcpy(to, from, sizeof(from));
+    EXPECT_EQ(to[0], from[0]);
+    EXPECT_EQ(to[1], from[1]);
+}
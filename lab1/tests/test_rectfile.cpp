@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "RectFile.h"
+
+namespace {
+
+std::string tempPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+}
+
+TEST(RectFile, RoundTrip) {
+    std::string path = tempPath("rects_roundtrip.bin");
+    std::vector<Rect2D> rects;
+    for (int i = 0; i < 1000; ++i) rects.emplace_back(i, -i, i * 3 % 17, i * 7 % 23);
+    ASSERT_TRUE(saveRects(path, rects));
+
+    RectFile file;
+    ASSERT_TRUE(file.open(path));
+    EXPECT_EQ(file.size(), rects.size());
+    std::span<const Rect2D> loaded = file.rects();
+    ASSERT_EQ(loaded.size(), rects.size());
+    EXPECT_TRUE(std::equal(loaded.begin(), loaded.end(), rects.begin()));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(loaded.data()) % alignof(Rect2D), 0u);
+
+    file.close();
+    EXPECT_FALSE(file.isOpen());
+    EXPECT_TRUE(file.rects().empty());
+    std::remove(path.c_str());
+}
+
+TEST(RectFile, Empty) {
+    std::string path = tempPath("rects_empty.bin");
+    ASSERT_TRUE(saveRects(path, {}));
+    RectFile file(path);
+    EXPECT_TRUE(file.isOpen());
+    EXPECT_TRUE(file.rects().empty());
+    std::remove(path.c_str());
+}
+
+TEST(RectFile, RejectsMalformed) {
+    std::string path = tempPath("rects_bad.bin");
+    std::vector<Rect2D> rects(3, Rect2D(0, 0, 1, 1));
+    ASSERT_TRUE(saveRects(path, rects));
+    std::string bytes;
+    {
+        std::ifstream is(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(is), {});
+    }
+    auto write = [&](const std::string& data) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(data.data(), data.size());
+    };
+    RectFile file;
+
+    write(bytes.substr(0, bytes.size() - 1));
+    EXPECT_FALSE(file.open(path));
+    write(bytes + std::string(16, '\0'));
+    EXPECT_FALSE(file.open(path));
+    write("RECX" + bytes.substr(4));
+    EXPECT_FALSE(file.open(path));
+    write(bytes.substr(0, 8));
+    EXPECT_FALSE(file.open(path));
+    EXPECT_FALSE(file.open(tempPath("rects_missing.bin")));
+    EXPECT_FALSE(file.isOpen());
+
+    write(bytes);
+    EXPECT_TRUE(file.open(path));
+    EXPECT_EQ(file.size(), 3u);
+    std::remove(path.c_str());
+}
+
+TEST(RectFile, FailedSaveRemovesTempFile) {
+    // A non-empty directory in the way makes the final rename fail.
+    std::string path = tempPath("rects_blocked.bin");
+    std::filesystem::create_directories(path + "/inside");
+    std::vector<Rect2D> rects(3, Rect2D(0, 0, 1, 1));
+    EXPECT_FALSE(saveRects(path, rects));
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+    std::filesystem::remove_all(path);
+}
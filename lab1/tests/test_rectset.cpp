@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include "RectSet.h"
+
+namespace {
+
+std::vector<Rect2D> randomRects(size_t n, std::mt19937& rng) {
+    std::uniform_int_distribution<int> coord(-50, 50);
+    std::vector<Rect2D> rects;
+    for (size_t i = 0; i < n; ++i)
+        rects.emplace_back(coord(rng), coord(rng), coord(rng), coord(rng));
+    return rects;
+}
+
+std::vector<SimdLevel> levels() {
+    std::vector<SimdLevel> out{SimdLevel::Scalar};
+    if (simdLevel() == SimdLevel::AVX2) out.push_back(SimdLevel::AVX2);
+    return out;
+}
+
+}
+
+TEST(RectSet, StoresNormalized) {
+    RectSet set({Rect2D(5, 5, 1, 1), Rect2D(0, 3, 2, -1)});
+    ASSERT_EQ(set.size(), 2);
+    EXPECT_EQ(set.x1()[0], 1);
+    EXPECT_EQ(set.y2()[1], 3);
+    EXPECT_TRUE(set[0] == Rect2D(1, 1, 5, 5));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(set.x1().data()) % 32, 0u);
+}
+
+TEST(RectSet, BatchOpsMatchRect2D) {
+    std::mt19937 rng(9);
+    for (SimdLevel level : levels()) {
+        for (size_t n : {0, 1, 7, 8, 9, 100}) {
+            std::vector<Rect2D> rects = randomRects(n, rng);
+            std::vector<Rect2D> others = randomRects(n, rng);
+            Rect2D q(-10, -20, 15, 5);
+
+            RectSet cut(rects), grown(rects), pairCut(rects), pairGrown(rects), moved(rects), resized(rects);
+            cut.intersectWith(q, level);
+            grown.uniteWith(q, level);
+            ASSERT_TRUE(pairCut.intersectWith(RectSet(others), level));
+            ASSERT_TRUE(pairGrown.uniteWith(RectSet(others), level));
+            moved.move(3, -4, level);
+            resized.resize(6, 2, level);
+            resized.resize(-1, 5, level);
+
+            std::vector<int64_t> areas;
+            RectSet(rects).areas(areas, level);
+            std::vector<size_t> hits, inside;
+            RectSet(rects).containing(0, 0, hits, level);
+            RectSet(rects).containedIn(q, inside, level);
+
+            std::vector<size_t> expectedHits, expectedInside;
+            for (size_t i = 0; i < n; ++i) {
+                Rect2D r = rects[i];
+                EXPECT_TRUE(cut[i] == r - q);
+                EXPECT_TRUE(grown[i] == r + q);
+                EXPECT_TRUE(pairCut[i] == r - others[i]);
+                EXPECT_TRUE(pairGrown[i] == r + others[i]);
+                Rect2D m = r;
+                m.move(3, -4);
+                EXPECT_TRUE(moved[i] == m);
+                Rect2D s = r;
+                s.resize(6, 2);
+                EXPECT_TRUE(resized[i] == s);
+                EXPECT_EQ(areas[i], int64_t(r.width()) * r.height());
+                if (r.contains(0, 0)) expectedHits.push_back(i);
+                if (q.contains(r)) expectedInside.push_back(i);
+            }
+            EXPECT_EQ(hits, expectedHits);
+            EXPECT_EQ(inside, expectedInside);
+        }
+    }
+}
+
+TEST(RectSet, PairwiseNeedsEqualSizes) {
+    RectSet a({Rect2D(0, 0, 1, 1)});
+    RectSet b;
+    EXPECT_FALSE(a.intersectWith(b));
+    EXPECT_FALSE(a.uniteWith(b));
+    EXPECT_TRUE(a[0] == Rect2D(0, 0, 1, 1));
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "RectText.h"
+
+TEST(RectText, ParsesLikeStreamOperator) {
+    std::string text = "1 2 3 4\n5\t6 -7 +8\r\n\n  9 9\n0 0\n";
+    std::vector<Rect2D> rects;
+    RectParseResult result = parseRects(text, rects);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_EQ(result.count, 3u);
+
+    std::istringstream is(text);
+    std::vector<Rect2D> expected;
+    for (Rect2D r; is >> r;) expected.push_back(r);
+    EXPECT_EQ(rects, expected);
+    EXPECT_EQ(rects[1], Rect2D(-7, 6, 5, 8));
+}
+
+TEST(RectText, FillsRectSet) {
+    RectSet set;
+    RectParseResult result = parseRects("4 4 0 0 1 1 2 2", set);
+    ASSERT_TRUE(result.ok);
+    ASSERT_EQ(set.size(), 2u);
+    EXPECT_EQ(set[0], Rect2D(0, 0, 4, 4));
+    EXPECT_EQ(set.x2()[1], 2);
+}
+
+TEST(RectText, ReportsErrorPosition) {
+    std::vector<Rect2D> rects;
+    RectParseResult result = parseRects("1 2 3 4\n5 6 x 8\n", rects);
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.count, 1u);
+    EXPECT_EQ(rects.size(), 1u);
+    EXPECT_EQ(result.line, 2u);
+    EXPECT_EQ(result.column, 5u);
+
+    result = parseRects("1 2 3 4\n  5 6 7\n", rects);
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.line, 2u);
+    EXPECT_EQ(result.column, 3u);
+
+    result = parseRects("1 2 3 99999999999", rects);
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.column, 7u);
+
+    result = parseRects("1 2 3 4,", rects);
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.column, 8u);
+
+    result = parseRects("+-1 2 3 4", rects);
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.column, 1u);
+}
+
+TEST(RectText, FormatMatchesStreamOperator) {
+    std::vector<Rect2D> rects = {Rect2D(), Rect2D(3, 1, -2, 7), Rect2D(INT_MIN, INT_MIN, INT_MAX, INT_MAX)};
+    std::string text;
+    formatRects(rects, text);
+    std::ostringstream os;
+    for (const Rect2D& r : rects) os << r << '\n';
+    EXPECT_EQ(text, os.str());
+
+    char buf[kRectTextMax];
+    EXPECT_EQ(formatRect(buf, Rect2D(INT_MIN, INT_MIN, INT_MIN, INT_MIN)), buf + kRectTextMax);
+}
+
+TEST(RectText, RoundTripThroughFile) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> coord(INT_MIN, INT_MAX);
+    std::vector<Rect2D> rects;
+    for (int i = 0; i < 10000; ++i) rects.emplace_back(coord(rng), coord(rng), coord(rng), coord(rng));
+    std::string text;
+    formatRects(rects, text);
+    std::string path = ::testing::TempDir() + "rects.txt";
+    std::ofstream(path, std::ios::binary).write(text.data(), text.size());
+
+    std::vector<Rect2D> loaded;
+    RectParseResult result = loadRects(path, loaded);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_EQ(loaded, rects);
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(loadRects(path, loaded).ok);
+}
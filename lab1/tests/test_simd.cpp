@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include "SimdSearch.h"
+
+namespace {
+
+std::vector<SimdLevel> supportedLevels() {
+    std::vector<SimdLevel> levels{SimdLevel::Scalar};
+    if (simdLevel() != SimdLevel::Scalar) levels.push_back(SimdLevel::SSE2);
+    if (simdLevel() == SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+    return levels;
+}
+
+}
+
+TEST(SimdSearch, MatchesStdFind) {
+    std::mt19937 rng(11);
+    for (SimdLevel level : supportedLevels()) {
+        for (int i = 0; i < 3000; ++i) {
+            std::string hay(rng() % 200, 'a');
+            for (char& c : hay) c = "ab_"[rng() % 3];
+            std::string needle(1 + rng() % 8, 'a');
+            for (char& c : needle) c = "ab_"[rng() % 3];
+            size_t hit = simdFind(hay.data(), hay.size(), needle.data(), needle.size(), level);
+            ASSERT_EQ(hit, hay.find(needle)) << hay << " / " << needle;
+        }
+    }
+}
+
+TEST(SimdSearch, MatchAtVectorBoundaries) {
+    for (SimdLevel level : supportedLevels()) {
+        for (size_t at = 0; at < 70; ++at) {
+            std::string hay(80, '1');
+            hay[at + 1] = '_';
+            EXPECT_EQ(simdFind(hay.data(), hay.size(), "1_1", 3, level), at);
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include "RTree.h"
+#include "RectGrid.h"
+
+namespace {
+
+Rect2D randomRect(std::mt19937& rng) {
+    std::uniform_int_distribution<int> coord(-500, 500), size(0, 40);
+    int x = coord(rng), y = coord(rng);
+    return Rect2D(x, y, x + size(rng), y + size(rng));
+}
+
+// Checks every query of an index against a linear scan over live rects.
+template<class Index>
+void checkQueries(const Index& index, const std::vector<Rect2D>& rects,
+                  const std::vector<bool>& live, std::mt19937& rng) {
+    std::uniform_int_distribution<int> coord(-550, 550);
+    for (int q = 0; q < 100; ++q) {
+        int x = coord(rng), y = coord(rng);
+        Rect2D window(x, y, x + int(rng() % 120), y + int(rng() % 120));
+        std::vector<uint32_t> expectPoint, expectWindow;
+        std::vector<int64_t> distances;
+        for (uint32_t id = 0; id < rects.size(); ++id) {
+            if (!live[id]) continue;
+            if (rects[id].contains(x, y)) expectPoint.push_back(id);
+            if (!((rects[id] - window) == Rect2D(0, 0, 0, 0))) expectWindow.push_back(id);
+            distances.push_back(rects[id].distance2(x, y));
+        }
+        std::sort(distances.begin(), distances.end());
+
+        std::vector<uint32_t> point, inWindow, near;
+        index.queryPoint(x, y, point);
+        index.queryWindow(window, inWindow);
+        index.nearest(x, y, 5, near);
+        std::sort(point.begin(), point.end());
+        std::sort(inWindow.begin(), inWindow.end());
+        EXPECT_EQ(point, expectPoint);
+        EXPECT_EQ(inWindow, expectWindow);
+        ASSERT_EQ(near.size(), std::min<size_t>(5, distances.size()));
+        for (size_t i = 0; i < near.size(); ++i)
+            EXPECT_EQ(index.rect(near[i]).distance2(x, y), distances[i]);
+    }
+}
+
+template<class Index>
+void checkIndex() {
+    std::mt19937 rng(21);
+    std::vector<Rect2D> rects;
+    for (int i = 0; i < 2000; ++i) rects.push_back(randomRect(rng));
+    std::vector<bool> live(rects.size(), true);
+    Index index(rects);
+    EXPECT_EQ(index.size(), rects.size());
+    checkQueries(index, rects, live, rng);
+
+    for (int i = 0; i < 1500; ++i) {
+        uint32_t id = rng() % rects.size();
+        switch (rng() % 4) {
+        case 0:
+            rects[id].move(int(rng() % 61) - 30, int(rng() % 61) - 30);
+            EXPECT_EQ(index.update(id, rects[id]), bool(live[id]));
+            break;
+        case 1:
+            rects[id].resize(int(rng() % 50), int(rng() % 50));
+            EXPECT_EQ(index.update(id, rects[id]), bool(live[id]));
+            break;
+        case 2:
+            EXPECT_EQ(index.remove(id), bool(live[id]));
+            live[id] = false;
+            break;
+        default:
+            rects.push_back(randomRect(rng));
+            live.push_back(true);
+            EXPECT_EQ(index.insert(rects.back()), rects.size() - 1);
+        }
+    }
+    EXPECT_EQ(index.size(), size_t(std::count(live.begin(), live.end(), true)));
+    checkQueries(index, rects, live, rng);
+}
+
+}
+
+TEST(SpatialIndex, RTreeMatchesLinearScan) {
+    checkIndex<RTree>();
+}
+
+TEST(SpatialIndex, GridMatchesLinearScan) {
+    checkIndex<RectGrid>();
+}
+
+TEST(SpatialIndex, GridKeepsHugeRectsApart) {
+    std::mt19937 rng(22);
+    std::vector<Rect2D> rects;
+    for (int i = 0; i < 2000; ++i) rects.push_back(randomRect(rng));
+    rects.push_back(Rect2D(-1000000000, -1000000000, 1000000000, 1000000000));
+    rects.push_back(Rect2D(-600, 0, 600, 3));
+    std::vector<bool> live(rects.size(), true);
+    RectGrid grid(rects);
+    EXPECT_LE(grid.cellSize(), 80);
+    checkQueries(grid, rects, live, rng);
+
+    // Growing a small rectangle past the span limit and shrinking a huge one.
+    rects[0] = Rect2D(-700, -700, 700, 700);
+    EXPECT_TRUE(grid.update(0, rects[0]));
+    rects[2000] = Rect2D(5, 5, 9, 9);
+    EXPECT_TRUE(grid.update(2000, rects[2000]));
+    EXPECT_TRUE(grid.remove(2001));
+    live[2001] = false;
+    checkQueries(grid, rects, live, rng);
+
+    RectGrid onlyHuge({Rect2D(-1000000000, 0, 1000000000, 10)}, 1);
+    std::vector<uint32_t> out;
+    onlyHuge.nearest(0, 50, 1, out);
+    EXPECT_EQ(out, std::vector<uint32_t>{0});
+}
+
+TEST(SpatialIndex, EmptyIndexes) {
+    RTree tree;
+    RectGrid grid;
+    std::vector<uint32_t> out;
+    tree.queryWindow(Rect2D(0, 0, 10, 10), out);
+    grid.queryWindow(Rect2D(0, 0, 10, 10), out);
+    tree.nearest(0, 0, 3, out);
+    grid.nearest(0, 0, 3, out);
+    EXPECT_TRUE(out.empty());
+    EXPECT_FALSE(tree.remove(0));
+    EXPECT_EQ(tree.insert(Rect2D(0, 0, 4, 4)), 0u);
+    tree.queryPoint(1, 1, out);
+    EXPECT_EQ(out, std::vector<uint32_t>{0});
+}
+
+TEST(SpatialIndex, TouchingIsNotOverlap) {
+    RTree tree({Rect2D(0, 0, 10, 10)});
+    RectGrid grid({Rect2D(0, 0, 10, 10)}, 4);
+    std::vector<uint32_t> out;
+    tree.queryWindow(Rect2D(10, 0, 20, 10), out);
+    grid.queryWindow(Rect2D(10, 0, 20, 10), out);
+    tree.queryPoint(10, 5, out);
+    grid.queryPoint(10, 5, out);
+    EXPECT_TRUE(out.empty());
+}
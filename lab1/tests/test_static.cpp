@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "PostMachine.h"
+#include "StaticPostMachine.h"
+
+namespace {
+
+using UnaryAdd = StaticPostMachine<StaticRule<"1+", "+1">, StaticRule<"+", "", false>>;
+using Collapse = StaticPostMachine<StaticRule<"aa", "b">, StaticRule<"a", "z">>;
+using Mixed = StaticPostMachine<StaticRule<"cd", "x">, StaticRule<"abcab", "c">,
+                                StaticRule<"bb", "a">, StaticRule<"ca", "ac", false>>;
+
+}
+
+TEST(StaticPostMachine, DefaultTape) {
+    UnaryAdd pm;
+    EXPECT_EQ(pm.tape(), "_");
+    UnaryAdd empty("");
+    EXPECT_EQ(empty.tape(), "_");
+}
+
+TEST(StaticPostMachine, UnaryAddition) {
+    UnaryAdd pm("11+111=");
+    pm.run();
+    EXPECT_EQ(pm.tape(), "11111=");
+    EXPECT_EQ(pm.steps(), 3);
+}
+
+TEST(StaticPostMachine, StepFirstMatch) {
+    Collapse pm("aa");
+    ASSERT_TRUE(pm.step());
+    EXPECT_EQ(pm.tape(), "b");
+    EXPECT_EQ(pm.pos(), 1);
+    EXPECT_FALSE(pm.step());
+}
+
+TEST(StaticPostMachine, RunLimitAndReset) {
+    Collapse pm("aaa");
+    pm.run(1);
+    EXPECT_EQ(pm.tape(), "ba");
+    pm.reset("aaaa");
+    EXPECT_EQ(pm.steps(), 0);
+    pm.run();
+    EXPECT_EQ(pm.tape(), "bb");
+}
+
+TEST(StaticPostMachine, AgreesWithPostMachine) {
+    std::mt19937 rng(5);
+    for (int trial = 0; trial < 50; ++trial) {
+        std::string tape(1 + rng() % 300, 'a');
+        for (char& c : tape) c = "abcd"[rng() % 4];
+
+        Mixed fixed(tape);
+        PostMachine dynamic(tape);
+        dynamic.addRule("cd", "x");
+        dynamic.addRule("abcab", "c");
+        dynamic.addRule("bb", "a");
+        dynamic.addRule("ca", "ac", false);
+        for (int i = 0; i < 400; ++i) {
+            bool moved = dynamic.step();
+            ASSERT_EQ(fixed.step(), moved);
+            if (!moved) break;
+        }
+        EXPECT_EQ(fixed.tape(), dynamic.tape());
+        EXPECT_EQ(fixed.pos(), dynamic.pos());
+    }
+}
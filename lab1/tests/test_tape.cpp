@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include "FileTape.h"
+#include "RleTape.h"
+#include "TapeStorage.h"
+
+namespace {
+
+// Applies the same random rewrites to a backend and to std::string.
+void checkAgainstString(TapeBackend backend) {
+    std::mt19937 rng(7);
+    std::string expected(3000, 'a');
+    for (size_t i = 0; i < expected.size(); i += 7) expected[i] = 'b';
+    auto tape = makeTape(backend, expected);
+
+    for (int i = 0; i < 2000; ++i) {
+        size_t pos = rng() % (expected.size() + 1);
+        size_t len = std::min<size_t>(rng() % 4, expected.size() - pos);
+        std::string text(rng() % 5, "abc"[rng() % 3]);
+        expected.replace(pos, len, text);
+        tape->replace(pos, len, text);
+    }
+    ASSERT_EQ(tape->size(), expected.size());
+    EXPECT_EQ(tape->str(), expected);
+    EXPECT_EQ(tape->at(expected.size() / 2), expected[expected.size() / 2]);
+    EXPECT_EQ(tape->copy(100, 50), expected.substr(100, 50));
+    for (const char* p : {"ab", "cca", "bbbb", "abcabc"}) {
+        EXPECT_EQ(tape->find(p, 0), expected.find(p));
+        EXPECT_EQ(tape->find(p, 1000), expected.find(p, 1000));
+    }
+}
+
+}
+
+TEST(TapeStorage, StringMatchesReference) {
+    checkAgainstString(TapeBackend::String);
+}
+
+TEST(TapeStorage, GapBufferMatchesReference) {
+    checkAgainstString(TapeBackend::GapBuffer);
+}
+
+TEST(TapeStorage, RopeMatchesReference) {
+    checkAgainstString(TapeBackend::Rope);
+}
+
+TEST(TapeStorage, RunLengthMatchesReference) {
+    checkAgainstString(TapeBackend::RunLength);
+}
+
+TEST(TapeStorage, FileMatchesReference) {
+    checkAgainstString(TapeBackend::File);
+}
+
+TEST(TapeStorage, FileCompactsPieceTable) {
+    std::string expected(5000, 'a');
+    auto tape = FileTape::fromData(expected);
+    ASSERT_TRUE(tape);
+    for (size_t i = 0; i < 3 * FileTape::kCompactAfterPieces; ++i) {
+        size_t pos = (i * 37) % expected.size();
+        expected.replace(pos, 1, "b");
+        tape->replace(pos, 1, "b");
+    }
+    EXPECT_LE(tape->pieceCount(), 2 * FileTape::kCompactAfterPieces);
+    EXPECT_LE(tape->fileCount(), 2u);
+    EXPECT_EQ(tape->str(), expected);
+    EXPECT_EQ(tape->find("ab", 0), expected.find("ab"));
+}
+
+TEST(TapeStorage, FileCompactionKeepsCleanPieces) {
+    std::string expected(4 * FileTape::kSmallPiece, 'a');
+    auto tape = FileTape::fromData(expected);
+    ASSERT_TRUE(tape);
+    auto before = tape->clone();
+    // Edits only near both ends: the middle stays one piece of the working file.
+    for (size_t i = 0; i < 2 * FileTape::kCompactAfterPieces; ++i) {
+        size_t pos = i % 2 ? (i * 13) % 1000 : expected.size() - 1 - (i * 13) % 1000;
+        expected.replace(pos, 1, i % 3 ? "b" : "cc");
+        tape->replace(pos, 1, i % 3 ? "b" : "cc");
+    }
+    EXPECT_LE(tape->pieceCount(), 2 * FileTape::kCompactAfterPieces);
+    EXPECT_EQ(tape->str(), expected);
+    EXPECT_EQ(before->str(), std::string(4 * FileTape::kSmallPiece, 'a'));
+    EXPECT_EQ(tape->find("cca", 0), expected.find("cca"));
+    EXPECT_EQ(tape->at(expected.size() / 2), 'a');
+}
+
+TEST(TapeStorage, FileSpillsOutsideInputDirectory) {
+    auto dir = std::filesystem::path(::testing::TempDir()) / "posttape_input";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "tape.txt").string();
+    std::string expected(3000, 'a');
+    std::ofstream(path, std::ios::binary) << expected;
+
+    auto tape = FileTape::open(path);
+    ASSERT_TRUE(tape);
+    for (size_t i = 0; i < 2 * FileTape::kCompactAfterPieces; ++i) {
+        expected.replace((i * 37) % expected.size(), 1, "b");
+        tape->replace((i * 37) % expected.size(), 1, "b");
+    }
+    EXPECT_LT(tape->pieceCount(), 2 * FileTape::kCompactAfterPieces);
+    EXPECT_EQ(tape->str(), expected);
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()), 1);
+    tape.reset();
+    std::filesystem::remove_all(dir);
+}
+
+TEST(TapeStorage, RunLengthEditInsideRun) {
+    RleTape tape(std::string(1000000, '1') + "_" + std::string(5, '1'));
+    EXPECT_EQ(tape.runCount(), 3);
+    tape.replace(500000, 1, "");
+    tape.replace(10, 0, "11");
+    EXPECT_EQ(tape.runCount(), 3);
+    EXPECT_EQ(tape.size(), 1000007);
+    EXPECT_EQ(tape.find("1_1", 0), 1000000);
+    EXPECT_EQ(tape.find("_11111", 0), 1000001);
+    EXPECT_EQ(tape.find("_111111", 0), TapeStorage::npos);
+    tape.replace(1000001, 1, "1");
+    EXPECT_EQ(tape.runCount(), 1);
+}
+
+TEST(TapeStorage, FindInStopsAtBound) {
+    auto tape = makeTape(TapeBackend::Rope, std::string(2000, 'a') + "xyz" + std::string(2000, 'a'));
+    EXPECT_EQ(tape->findIn("xyz", 0, 2001), 2000);
+    EXPECT_EQ(tape->findIn("xyz", 0, 2000), TapeStorage::npos);
+    EXPECT_EQ(tape->findIn("xyz", 2001, 4003), TapeStorage::npos);
+    EXPECT_EQ(tape->findIn("aax", 1990, 2000), 1998);
+}
+
+TEST(TapeStorage, CloneIsIndependent) {
+    auto tape = makeTape(TapeBackend::Rope, "hello");
+    auto copy = tape->clone();
+    tape->replace(0, 1, "J");
+    EXPECT_EQ(tape->str(), "Jello");
+    EXPECT_EQ(copy->str(), "hello");
+}
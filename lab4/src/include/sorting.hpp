@@ -8,9 +8,185 @@
 #include <limits>
 #include <algorithm>
 #include <iterator>
+#include <utility>
+#include <thread>
+#include <exception>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
 
 namespace lab {
 
+    namespace detail {
+
+        template<typename Iterator>
+        constexpr bool is_random_access_v = std::is_base_of_v<
+            std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
+
+        // Stable: each element is moved past the run of elements greater than
+        // it, found by binary search, so it costs O(n log n) comparisons.
+        template<typename Iterator, typename Compare>
+        void binary_insertion_sort(Iterator first, Iterator last, Compare& comp) {
+            using value_type = typename std::iterator_traits<Iterator>::value_type;
+            if (first == last) return;
+            for (Iterator it = std::next(first); it != last; ++it) {
+                if (!comp(*it, *std::prev(it))) continue;
+                value_type key = std::move(*it);
+                Iterator pos = std::upper_bound(first, it, key, comp);
+                std::move_backward(pos, it, std::next(it));
+                *pos = std::move(key);
+            }
+        }
+
+        // Calls fn(t, begin, end) for threads equal slices of [0, n), slice t
+        // on thread t (the last one on the caller). Rethrows the first
+        // exception after all of them have finished.
+        template<typename Fn>
+        void run_slices(std::size_t threads, std::size_t n, Fn fn) {
+            std::vector<std::exception_ptr> errors(threads);
+            auto slice = [&](std::size_t t) {
+                try {
+                    fn(t, n * t / threads, n * (t + 1) / threads);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+            for (std::size_t t = 0; t + 1 < threads; ++t) workers.emplace_back(slice, t);
+            slice(threads - 1);
+            for (auto& worker : workers) worker.join();
+            for (auto& error : errors) {
+                if (error) std::rethrow_exception(error);
+            }
+        }
+
+        // Storage for n objects of T that the owner constructs and destroys
+        // itself; only the memory is released here.
+        template<typename T>
+        class raw_buffer {
+        public:
+            explicit raw_buffer(std::size_t n) : data_(std::allocator<T>().allocate(n)), size_(n) {}
+            ~raw_buffer() { std::allocator<T>().deallocate(data_, size_); }
+            raw_buffer(const raw_buffer&) = delete;
+            raw_buffer& operator=(const raw_buffer&) = delete;
+
+            T* data() const { return data_; }
+
+        private:
+            T* data_;
+            std::size_t size_;
+        };
+
+        // Order-preserving map from a key to an unsigned integer of the same
+        // width: signed integers get their sign bit flipped; floats get all
+        // bits flipped if negative, otherwise only the sign bit, which orders
+        // -0 before +0 and NaNs by their sign and payload.
+        template<typename Key, typename = void>
+        struct radix_key;
+
+        template<typename Key>
+        struct radix_key<Key, std::enable_if_t<std::is_integral_v<Key>>> {
+            static_assert(!std::is_same_v<Key, bool>, "bool keys are not supported");
+            using bits_type = std::make_unsigned_t<Key>;
+            static constexpr bits_type flip = std::is_signed_v<Key>
+                ? bits_type(bits_type(1) << (sizeof(Key) * 8 - 1)) : bits_type(0);
+
+            static bits_type to_bits(Key key) { return static_cast<bits_type>(static_cast<bits_type>(key) ^ flip); }
+            static Key from_bits(bits_type bits) { return static_cast<Key>(static_cast<bits_type>(bits ^ flip)); }
+        };
+
+        template<typename Key>
+        struct radix_key<Key, std::enable_if_t<std::is_floating_point_v<Key>>> {
+            static_assert(sizeof(Key) == 4 || sizeof(Key) == 8, "only 32 and 64-bit floating point keys are supported");
+            using bits_type = std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t>;
+            static constexpr bits_type sign = bits_type(1) << (sizeof(Key) * 8 - 1);
+
+            static bits_type to_bits(Key key) {
+                bits_type bits;
+                std::memcpy(&bits, &key, sizeof(key));
+                return (bits & sign) ? ~bits : bits | sign;
+            }
+            static Key from_bits(bits_type bits) {
+                bits = (bits & sign) ? bits & ~sign : ~bits;
+                Key key;
+                std::memcpy(&key, &bits, sizeof(key));
+                return key;
+            }
+        };
+
+        // A key to sort by and where its element came from.
+        template<typename Bits, typename Index>
+        struct radix_item {
+            Bits key;
+            Index index;
+        };
+
+        template<typename Bits>
+        Bits radix_bits(Bits bits) { return bits; }
+
+        template<typename Bits, typename Index>
+        Bits radix_bits(const radix_item<Bits, Index>& item) { return item.key; }
+
+        template<typename Index>
+        void check_index_capacity(std::size_t n) {
+            static_assert(std::is_integral_v<Index> && std::is_unsigned_v<Index>, "Index must be an unsigned integer type");
+            if (n > 0 && n - 1 > std::numeric_limits<Index>::max()) {
+                throw std::length_error("too many elements for the index type");
+            }
+        }
+
+        // Argsort for any comparison sorter: sorts the indices by the
+        // elements they refer to, leaving the elements in place.
+        template<typename Sorter, typename Index, typename Iterator, typename Compare>
+        std::vector<Index> comparison_argsort(Iterator first, Iterator last, Compare& comp) {
+            static_assert(is_random_access_v<Iterator>, "argsort requires random access iterators");
+            std::size_t n = static_cast<std::size_t>(last - first);
+            check_index_capacity<Index>(n);
+            std::vector<Index> perm(n);
+            for (std::size_t i = 0; i < n; ++i) perm[i] = static_cast<Index>(i);
+            Sorter::sort(perm.begin(), perm.end(), [&](Index a, Index b) { return comp(first[a], first[b]); });
+            return perm;
+        }
+
+    } // namespace detail
+
+    // Reorders range so that the new range[i] is the old range[perm[i]], as
+    // returned by the argsort functions. Follows the cycles of perm, so each
+    // element is moved once plus once per cycle through a temporary; a bitmap
+    // of n bits marks the positions still to do. Throws std::invalid_argument
+    // if perm is not a permutation of 0..n-1, leaving range unchanged.
+    template<typename Range, typename Index>
+    void apply_permutation(Range& range, const std::vector<Index>& perm) {
+        auto first = std::begin(range);
+        static_assert(detail::is_random_access_v<decltype(first)>, "apply_permutation requires random access iterators");
+        using value_type = typename std::iterator_traits<decltype(first)>::value_type;
+        std::size_t n = static_cast<std::size_t>(std::end(range) - first);
+        if (perm.size() != n) throw std::invalid_argument("permutation size does not match the range");
+
+        std::vector<bool> pending(n, false);
+        for (Index p : perm) {
+            if (static_cast<std::size_t>(p) >= n || pending[p]) throw std::invalid_argument("not a permutation");
+            pending[p] = true;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!pending[i]) continue;
+            pending[i] = false;
+            std::size_t src = perm[i];
+            if (src == i) continue;
+            value_type carry = std::move(first[i]);
+            std::size_t dst = i;
+            while (src != i) {
+                first[dst] = std::move(first[src]);
+                pending[src] = false;
+                dst = src;
+                src = perm[src];
+            }
+            first[dst] = std::move(carry);
+        }
+    }
+
     class InsertionSort {
     public:
         template<typename Iterator, typename Compare = std::less<>>
@@ -18,14 +194,250 @@ namespace lab {
             using value_type = typename std::iterator_traits<Iterator>::value_type;
             if (first == last) return;
             for (Iterator it = std::next(first); it != last; ++it) {
-                value_type key = *it;
+                if (!comp(*it, *std::prev(it))) continue;
+                value_type key = std::move(*it);
                 Iterator j = it;
-                while (j != first && comp(key, *std::prev(j))) {
-                    *j = *std::prev(j);
+                do {
+                    *j = std::move(*std::prev(j));
                     --j;
-                }
+                } while (j != first && comp(key, *std::prev(j)));
+                *j = std::move(key);
+            }
+        }
+
+        // Indices ordered so that element perm[i] sorts to position i.
+        template<typename Index = std::uint32_t, typename Iterator, typename Compare = std::less<>>
+        static std::vector<Index> argsort(Iterator first, Iterator last, Compare comp = Compare{}) {
+            return detail::comparison_argsort<InsertionSort, Index>(first, last, comp);
+        }
+
+        template<typename Container, typename Compare = std::less<>>
+        void operator()(Container& container, Compare comp = Compare{}) const {
+            sort(container.begin(), container.end(), comp);
+        }
+
+        template<typename T, std::size_t N, typename Compare = std::less<>>
+        void operator()(T(&arr)[N], Compare comp = Compare{}) const {
+            sort(std::begin(arr), std::end(arr), comp);
+        }
+    };
+
+    // Pattern-defeating quicksort (O. Peters): median-of-3 or ninther pivots,
+    // partitions that put elements equal to the pivot together when the
+    // pivot repeats, a partial insertion sort that finishes already sorted
+    // runs in linear time, and a heap sort fallback after too many
+    // unbalanced partitions, so the worst case is O(n log n). Not stable.
+    // Requires random access iterators.
+    class PdqSort {
+    public:
+        template<typename Iterator, typename Compare = std::less<>>
+        static void sort(Iterator first, Iterator last, Compare comp = Compare{}) {
+            static_assert(detail::is_random_access_v<Iterator>, "PdqSort requires random access iterators");
+            auto size = last - first;
+            if (size < 2) return;
+            int bad_allowed = 0;
+            while (size > 1) {
+                size >>= 1;
+                ++bad_allowed;
+            }
+            sort_loop(first, last, comp, bad_allowed, true);
+        }
+
+        // Indices ordered so that element perm[i] sorts to position i.
+        template<typename Index = std::uint32_t, typename Iterator, typename Compare = std::less<>>
+        static std::vector<Index> argsort(Iterator first, Iterator last, Compare comp = Compare{}) {
+            return detail::comparison_argsort<PdqSort, Index>(first, last, comp);
+        }
+
+        template<typename Container, typename Compare = std::less<>>
+        void operator()(Container& container, Compare comp = Compare{}) const {
+            sort(container.begin(), container.end(), comp);
+        }
+
+        template<typename T, std::size_t N, typename Compare = std::less<>>
+        void operator()(T(&arr)[N], Compare comp = Compare{}) const {
+            sort(std::begin(arr), std::end(arr), comp);
+        }
+
+    private:
+        static constexpr std::ptrdiff_t insertion_threshold = 24;
+        static constexpr std::ptrdiff_t ninther_threshold = 128;
+        static constexpr std::ptrdiff_t partial_insertion_limit = 8;
+
+        template<typename Iterator, typename Compare>
+        static void sort2(Iterator a, Iterator b, Compare& comp) {
+            if (comp(*b, *a)) std::iter_swap(a, b);
+        }
+
+        template<typename Iterator, typename Compare>
+        static void sort3(Iterator a, Iterator b, Iterator c, Compare& comp) {
+            sort2(a, b, comp);
+            sort2(b, c, comp);
+            sort2(a, b, comp);
+        }
+
+        // Insertion sort that gives up once it has moved more than
+        // partial_insertion_limit elements; true if the range is now sorted.
+        template<typename Iterator, typename Compare>
+        static bool partial_insertion_sort(Iterator first, Iterator last, Compare& comp) {
+            using value_type = typename std::iterator_traits<Iterator>::value_type;
+            if (first == last) return true;
+            std::ptrdiff_t moved = 0;
+            for (Iterator it = first + 1; it != last; ++it) {
+                if (!comp(*it, *(it - 1))) continue;
+                value_type key = std::move(*it);
+                Iterator j = it;
+                do {
+                    *j = std::move(*(j - 1));
+                    --j;
+                } while (j != first && comp(key, *(j - 1)));
                 *j = std::move(key);
+                moved += it - j;
+                if (moved > partial_insertion_limit) return false;
             }
+            return true;
+        }
+
+        // Partitions [first, last) around the pivot *first into elements less
+        // than it and elements not less. Returns the final pivot position and
+        // whether no element had to be swapped. The pivot selection leaves an
+        // element not less than the pivot at the end, which bounds the scans.
+        template<typename Iterator, typename Compare>
+        static std::pair<Iterator, bool> partition_right(Iterator first, Iterator last, Compare& comp) {
+            using value_type = typename std::iterator_traits<Iterator>::value_type;
+            value_type pivot = std::move(*first);
+            Iterator lo = first;
+            Iterator hi = last;
+            while (comp(*++lo, pivot));
+            if (lo - 1 == first) {
+                while (lo < hi && !comp(*--hi, pivot));
+            } else {
+                while (!comp(*--hi, pivot));
+            }
+            bool already_partitioned = lo >= hi;
+            while (lo < hi) {
+                std::iter_swap(lo, hi);
+                while (comp(*++lo, pivot));
+                while (!comp(*--hi, pivot));
+            }
+            Iterator pivot_pos = lo - 1;
+            *first = std::move(*pivot_pos);
+            *pivot_pos = std::move(pivot);
+            return { pivot_pos, already_partitioned };
+        }
+
+        // Used when the pivot equals the element before the range: puts the
+        // elements equal to the pivot on the left, where they are done.
+        template<typename Iterator, typename Compare>
+        static Iterator partition_left(Iterator first, Iterator last, Compare& comp) {
+            using value_type = typename std::iterator_traits<Iterator>::value_type;
+            value_type pivot = std::move(*first);
+            Iterator lo = first;
+            Iterator hi = last;
+            while (comp(pivot, *--hi));
+            if (hi + 1 == last) {
+                while (lo < hi && !comp(pivot, *++lo));
+            } else {
+                while (!comp(pivot, *++lo));
+            }
+            while (lo < hi) {
+                std::iter_swap(lo, hi);
+                while (comp(pivot, *--hi));
+                while (!comp(pivot, *++lo));
+            }
+            *first = std::move(*hi);
+            *hi = std::move(pivot);
+            return hi;
+        }
+
+        // Swaps a few elements of a badly split side to break up the pattern
+        // that caused it.
+        template<typename Iterator>
+        static void break_patterns(Iterator first, Iterator last) {
+            auto size = last - first;
+            if (size < insertion_threshold) return;
+            auto quarter = size / 4;
+            std::iter_swap(first, first + quarter);
+            std::iter_swap(last - 1, last - quarter);
+            if (size > ninther_threshold) {
+                std::iter_swap(first + 1, first + (quarter + 1));
+                std::iter_swap(first + 2, first + (quarter + 2));
+                std::iter_swap(last - 2, last - (quarter + 1));
+                std::iter_swap(last - 3, last - (quarter + 2));
+            }
+        }
+
+        // Sorts the left side recursively and loops on the right one. Every
+        // range but the leftmost has an element not greater than all of its
+        // elements just before it.
+        template<typename Iterator, typename Compare>
+        static void sort_loop(Iterator first, Iterator last, Compare& comp, int bad_allowed, bool leftmost) {
+            for (;;) {
+                auto size = last - first;
+                if (size < insertion_threshold) {
+                    detail::binary_insertion_sort(first, last, comp);
+                    return;
+                }
+
+                auto half = size / 2;
+                if (size > ninther_threshold) {
+                    sort3(first, first + half, last - 1, comp);
+                    sort3(first + 1, first + (half - 1), last - 2, comp);
+                    sort3(first + 2, first + (half + 1), last - 3, comp);
+                    sort3(first + (half - 1), first + half, first + (half + 1), comp);
+                    std::iter_swap(first, first + half);
+                } else {
+                    sort3(first + half, first, last - 1, comp);
+                }
+
+                if (!leftmost && !comp(*(first - 1), *first)) {
+                    first = partition_left(first, last, comp) + 1;
+                    continue;
+                }
+
+                auto [pivot_pos, already_partitioned] = partition_right(first, last, comp);
+                auto left_size = pivot_pos - first;
+                auto right_size = last - (pivot_pos + 1);
+                if (left_size < size / 8 || right_size < size / 8) {
+                    if (--bad_allowed == 0) {
+                        std::make_heap(first, last, comp);
+                        std::sort_heap(first, last, comp);
+                        return;
+                    }
+                    break_patterns(first, pivot_pos);
+                    break_patterns(pivot_pos + 1, last);
+                } else if (already_partitioned && partial_insertion_sort(first, pivot_pos, comp) &&
+                           partial_insertion_sort(pivot_pos + 1, last, comp)) {
+                    return;
+                }
+
+                sort_loop(first, pivot_pos, comp, bad_allowed, leftmost);
+                first = pivot_pos + 1;
+                leftmost = false;
+            }
+        }
+    };
+
+    // Stable top-down merge sort: runs below insertion_threshold are binary
+    // insertion sorted, already ordered halves are not merged, and each merge
+    // moves the left half into a buffer of at most n/2 elements. Requires
+    // random access iterators.
+    class MergeSort {
+    public:
+        template<typename Iterator, typename Compare = std::less<>>
+        static void sort(Iterator first, Iterator last, Compare comp = Compare{}) {
+            static_assert(detail::is_random_access_v<Iterator>, "MergeSort requires random access iterators");
+            using value_type = typename std::iterator_traits<Iterator>::value_type;
+            if (last - first < 2) return;
+            std::vector<value_type> buffer;
+            buffer.reserve(static_cast<std::size_t>((last - first) / 2));
+            sort_range(first, last, comp, buffer);
+        }
+
+        // Indices ordered so that element perm[i] sorts to position i.
+        template<typename Index = std::uint32_t, typename Iterator, typename Compare = std::less<>>
+        static std::vector<Index> argsort(Iterator first, Iterator last, Compare comp = Compare{}) {
+            return detail::comparison_argsort<MergeSort, Index>(first, last, comp);
         }
 
         template<typename Container, typename Compare = std::less<>>
@@ -37,8 +449,237 @@ namespace lab {
         void operator()(T(&arr)[N], Compare comp = Compare{}) const {
             sort(std::begin(arr), std::end(arr), comp);
         }
+
+    private:
+        static constexpr std::ptrdiff_t insertion_threshold = 32;
+
+        template<typename Iterator, typename Compare, typename Buffer>
+        static void sort_range(Iterator first, Iterator last, Compare& comp, Buffer& buffer) {
+            if (last - first < insertion_threshold) {
+                detail::binary_insertion_sort(first, last, comp);
+                return;
+            }
+            Iterator mid = first + (last - first) / 2;
+            sort_range(first, mid, comp, buffer);
+            sort_range(mid, last, comp, buffer);
+            if (!comp(*mid, *(mid - 1))) return;
+
+            buffer.assign(std::make_move_iterator(first), std::make_move_iterator(mid));
+            auto left = buffer.begin();
+            Iterator right = mid;
+            Iterator out = first;
+            while (left != buffer.end() && right != last) {
+                if (comp(*right, *left)) *out++ = std::move(*right++);
+                else *out++ = std::move(*left++);
+            }
+            std::move(left, buffer.end(), out);
+        }
+    };
+
+    // Radix sorts over the bits of a key: integral (signed or unsigned, not
+    // bool) or 32/64-bit floating point, without range arguments. Keys are
+    // extracted once and sorted together with their element's index, after
+    // which every element is moved once into place; arithmetic elements
+    // sorted by their own value skip the indices. Both variants are stable.
+    //
+    // sort() is least significant digit first, DigitBits (1 to 16, 8 or 11
+    // typically, 16 for large inputs of wide keys) per pass, one counting
+    // pass over all digits up front and no pass for a digit all keys share.
+    // msd_sort() is most significant digit first: each bucket is split
+    // further only while it is large, so long keys with distinct prefixes
+    // finish after a few digits. Requires random access iterators.
+    class RadixSort {
+    public:
+        template<unsigned DigitBits = 8, typename Range, typename KeyFunc>
+        static void sort(Range& range, KeyFunc key_func) {
+            sort_by_key<DigitBits, false>(range, key_func);
+        }
+
+        template<unsigned DigitBits = 8, typename Range>
+        static void sort(Range& range) {
+            sort_values<DigitBits, false>(range);
+        }
+
+        template<unsigned DigitBits = 8, typename Range, typename KeyFunc>
+        static void msd_sort(Range& range, KeyFunc key_func) {
+            sort_by_key<DigitBits, true>(range, key_func);
+        }
+
+        template<unsigned DigitBits = 8, typename Range>
+        static void msd_sort(Range& range) {
+            sort_values<DigitBits, true>(range);
+        }
+
+        // Stable LSD order as indices: element perm[i] sorts to position i.
+        template<typename Index = std::uint32_t, unsigned DigitBits = 8, typename Range, typename KeyFunc>
+        static std::vector<Index> argsort(const Range& range, KeyFunc key_func) {
+            return sorted_indices<DigitBits, false, Index>(range, key_func);
+        }
+
+        template<typename Index = std::uint32_t, unsigned DigitBits = 8, typename Range>
+        static std::vector<Index> argsort(const Range& range) {
+            using value_type = std::decay_t<decltype(*std::begin(range))>;
+            static_assert(std::is_arithmetic_v<value_type>, "sorting by value needs arithmetic elements; pass a key function");
+            return argsort<Index, DigitBits>(range, [](const value_type& x) { return x; });
+        }
+
+        template<typename Range, typename KeyFunc>
+        void operator()(Range& range, KeyFunc key_func) const {
+            sort(range, key_func);
+        }
+
+        template<typename Range>
+        void operator()(Range& range) const {
+            sort(range);
+        }
+
+    private:
+        // Buckets smaller than this end an MSD descent with an insertion sort.
+        static constexpr std::size_t msd_insertion_threshold = 32;
+
+        template<unsigned DigitBits, bool Msd, typename Range>
+        static void sort_values(Range& range) {
+            using value_type = std::decay_t<decltype(*std::begin(range))>;
+            static_assert(std::is_arithmetic_v<value_type>, "sorting by value needs arithmetic elements; pass a key function");
+            using key_type = detail::radix_key<value_type>;
+            auto first = std::begin(range);
+            auto last = std::end(range);
+            static_assert(detail::is_random_access_v<decltype(first)>, "RadixSort requires random access iterators");
+
+            std::vector<typename key_type::bits_type> items;
+            items.reserve(static_cast<std::size_t>(last - first));
+            for (auto it = first; it != last; ++it) items.push_back(key_type::to_bits(*it));
+            sort_items<DigitBits, Msd>(items);
+            for (std::size_t i = 0; i < items.size(); ++i) first[i] = key_type::from_bits(items[i]);
+        }
+
+        template<unsigned DigitBits, bool Msd, typename Range, typename KeyFunc>
+        static void sort_by_key(Range& range, KeyFunc& key_func) {
+            if (static_cast<std::uint64_t>(std::size(range)) <= UINT32_MAX) {
+                sort_indexed<DigitBits, Msd, std::uint32_t>(range, key_func);
+            } else {
+                sort_indexed<DigitBits, Msd, std::uint64_t>(range, key_func);
+            }
+        }
+
+        template<unsigned DigitBits, bool Msd, typename Index, typename Range, typename KeyFunc>
+        static void sort_indexed(Range& range, KeyFunc& key_func) {
+            apply_permutation(range, sorted_indices<DigitBits, Msd, Index>(range, key_func));
+        }
+
+        template<unsigned DigitBits, bool Msd, typename Index, typename Range, typename KeyFunc>
+        static std::vector<Index> sorted_indices(const Range& range, KeyFunc& key_func) {
+            auto first = std::begin(range);
+            auto last = std::end(range);
+            static_assert(detail::is_random_access_v<decltype(first)>, "RadixSort requires random access iterators");
+            using key_type = detail::radix_key<std::decay_t<decltype(key_func(*first))>>;
+            using item_type = detail::radix_item<typename key_type::bits_type, Index>;
+
+            std::size_t n = static_cast<std::size_t>(last - first);
+            detail::check_index_capacity<Index>(n);
+            std::vector<item_type> items(n);
+            for (std::size_t i = 0; i < n; ++i) items[i] = { key_type::to_bits(key_func(first[i])), static_cast<Index>(i) };
+            sort_items<DigitBits, Msd>(items);
+
+            std::vector<Index> perm(n);
+            for (std::size_t i = 0; i < n; ++i) perm[i] = items[i].index;
+            return perm;
+        }
+
+        template<unsigned DigitBits, bool Msd, typename Item>
+        static void sort_items(std::vector<Item>& items) {
+            static_assert(DigitBits >= 1 && DigitBits <= 16, "DigitBits must be between 1 and 16");
+            if (items.size() < 2) return;
+            if constexpr (Msd) {
+                using bits_type = decltype(detail::radix_bits(items[0]));
+                std::vector<Item> buffer(items.size());
+                msd_sort_range<DigitBits>(items.data(), items.data() + items.size(), buffer.data(),
+                                          unsigned(sizeof(bits_type) * 8));
+            } else {
+                lsd_sort<DigitBits>(items);
+            }
+        }
+
+        template<unsigned DigitBits, typename Item>
+        static void lsd_sort(std::vector<Item>& items) {
+            using bits_type = decltype(detail::radix_bits(items[0]));
+            constexpr unsigned key_bits = sizeof(bits_type) * 8;
+            constexpr unsigned digits = (key_bits + DigitBits - 1) / DigitBits;
+            constexpr std::size_t radix = std::size_t(1) << DigitBits;
+            constexpr bits_type mask = bits_type(radix - 1);
+            std::size_t n = items.size();
+
+            std::vector<std::size_t> counts(digits * radix, 0);
+            for (const Item& item : items) {
+                bits_type key = detail::radix_bits(item);
+                for (unsigned d = 0; d < digits; ++d) ++counts[d * radix + ((key >> (d * DigitBits)) & mask)];
+            }
+
+            std::vector<Item> buffer(n);
+            for (unsigned d = 0; d < digits; ++d) {
+                std::size_t* row = counts.data() + d * radix;
+                unsigned shift = d * DigitBits;
+                if (row[(detail::radix_bits(items[0]) >> shift) & mask] == n) continue;
+                std::size_t sum = 0;
+                for (std::size_t b = 0; b < radix; ++b) {
+                    std::size_t count = row[b];
+                    row[b] = sum;
+                    sum += count;
+                }
+                for (const Item& item : items) buffer[row[(detail::radix_bits(item) >> shift) & mask]++] = item;
+                items.swap(buffer);
+            }
+        }
+
+        // Sorts [first, last) by the low `bits` bits of the keys, all higher
+        // bits being equal; buffer has room for last - first items.
+        template<unsigned DigitBits, typename Item>
+        static void msd_sort_range(Item* first, Item* last, Item* buffer, unsigned bits) {
+            using bits_type = decltype(detail::radix_bits(*first));
+            std::size_t n = static_cast<std::size_t>(last - first);
+            std::vector<std::size_t> counts;
+            while (bits > 0) {
+                if (n < msd_insertion_threshold) {
+                    auto by_key = [](const Item& a, const Item& b) { return detail::radix_bits(a) < detail::radix_bits(b); };
+                    detail::binary_insertion_sort(first, last, by_key);
+                    return;
+                }
+                unsigned width = std::min(bits, DigitBits);
+                unsigned shift = bits - width;
+                bits_type mask = bits_type((std::size_t(1) << width) - 1);
+                std::size_t radix = std::size_t(1) << width;
+                counts.assign(radix + 1, 0);
+                for (Item* it = first; it != last; ++it) ++counts[((detail::radix_bits(*it) >> shift) & mask) + 1];
+                bits = shift;
+                if (counts[((detail::radix_bits(*first) >> shift) & mask) + 1] == n) continue;
+
+                for (std::size_t b = 1; b <= radix; ++b) counts[b] += counts[b - 1];
+                std::vector<std::size_t> next(counts.begin(), counts.end() - 1);
+                for (Item* it = first; it != last; ++it) buffer[next[(detail::radix_bits(*it) >> shift) & mask]++] = *it;
+                std::copy(buffer, buffer + n, first);
+                if (bits == 0) return;
+                for (std::size_t b = 0; b < radix; ++b) {
+                    if (counts[b + 1] - counts[b] > 1) {
+                        msd_sort_range<DigitBits>(first + counts[b], first + counts[b + 1], buffer + counts[b], bits);
+                    }
+                }
+                return;
+            }
+        }
     };
 
+    // How CountingSort moves the elements:
+    //  copy     - copies them into an output vector and back; calls the key
+    //             function twice per element; extra memory O(range + n).
+    //  cached   - stores each element's key once, turns it into the
+    //             element's destination and moves the elements there along
+    //             permutation cycles; stable; extra memory O(range) plus a
+    //             32-bit (64-bit past 2^32 elements or keys) slot per element.
+    //  in_place - American flag sort: swaps each element straight into its
+    //             key's bucket; NOT stable; extra memory O(range) plus one
+    //             key of the smallest width that fits range per element.
+    enum class CountingMode { copy, cached, in_place };
+
     class CountingSort {
     public:
         template<typename Container, typename KeyFunc, typename KeyType = int>
@@ -77,6 +718,166 @@ namespace lab {
             std::copy(output.begin(), output.end(), container.begin());
         }
 
+        // sort() with the element handling chosen by mode (see CountingMode).
+        // Any container or array with random access iterators.
+        template<typename Range, typename KeyFunc, typename KeyType>
+        static void sort(Range& range, KeyFunc key_func, KeyType min_key, KeyType max_key, CountingMode mode) {
+            if (mode == CountingMode::copy) {
+                sort(range, key_func, min_key, max_key);
+                return;
+            }
+            static_assert(std::is_integral_v<KeyType>, "KeyType must be integral");
+            static_assert(detail::is_random_access_v<decltype(std::begin(range))>,
+                          "cached and in_place modes require random access iterators");
+            if (min_key > max_key) throw std::invalid_argument("min_key > max_key");
+            KeyType range_size = max_key - min_key + 1;
+            if (range_size <= 0) throw std::invalid_argument("invalid key range");
+
+            auto keys = static_cast<std::uint64_t>(range_size);
+            auto n = static_cast<std::uint64_t>(std::end(range) - std::begin(range));
+            if (mode == CountingMode::cached) {
+                if (std::max(n, keys) <= UINT32_MAX) cached_sort<std::uint32_t>(range, key_func, min_key, max_key);
+                else cached_sort<std::uint64_t>(range, key_func, min_key, max_key);
+            } else if (keys <= UINT8_MAX + 1) {
+                in_place_sort<std::uint8_t>(range, key_func, min_key, max_key);
+            } else if (keys <= UINT16_MAX + 1) {
+                in_place_sort<std::uint16_t>(range, key_func, min_key, max_key);
+            } else if (keys <= std::uint64_t(UINT32_MAX) + 1) {
+                in_place_sort<std::uint32_t>(range, key_func, min_key, max_key);
+            } else {
+                in_place_sort<std::uint64_t>(range, key_func, min_key, max_key);
+            }
+        }
+
+        // Stable order as indices: element perm[i] sorts to position i. The
+        // elements are not touched and the key function is called once each.
+        template<typename Index = std::uint32_t, typename Range, typename KeyFunc, typename KeyType>
+        static std::vector<Index> argsort(const Range& range, KeyFunc key_func, KeyType min_key, KeyType max_key) {
+            static_assert(std::is_integral_v<KeyType>, "KeyType must be integral");
+            auto first = std::begin(range);
+            static_assert(detail::is_random_access_v<decltype(first)>, "argsort requires random access iterators");
+            if (min_key > max_key) throw std::invalid_argument("min_key > max_key");
+            KeyType range_size = max_key - min_key + 1;
+            if (range_size <= 0) throw std::invalid_argument("invalid key range");
+
+            std::size_t n = static_cast<std::size_t>(std::end(range) - first);
+            detail::check_index_capacity<Index>(n);
+            detail::check_index_capacity<Index>(static_cast<std::size_t>(range_size));
+            std::vector<Index> keys(n);
+            std::vector<std::size_t> counts(static_cast<std::size_t>(range_size), 0);
+            extract_keys(first, keys, counts, key_func, min_key, max_key);
+
+            std::size_t sum = 0;
+            for (auto& count : counts) {
+                std::size_t c = count;
+                count = sum;
+                sum += c;
+            }
+            std::vector<Index> perm(n);
+            for (std::size_t i = 0; i < n; ++i) perm[counts[keys[i]]++] = static_cast<Index>(i);
+            return perm;
+        }
+
+        // Multithreaded sort() with the same stable result. Each thread
+        // counts the keys of its slice of the container; the output position
+        // of key k from slice t starts after all smaller keys and after key k
+        // in slices before t, so every thread can then copy-construct its
+        // slice into uninitialized output storage independently; the sorted
+        // elements are moved back slice by slice. The per-thread counter rows
+        // are padded to whole cache lines so threads never write to a shared
+        // line.
+        // threads = 0 uses one per hardware thread; small inputs and small
+        // slices fall back to sort(). Requires random access iterators.
+        template<typename Container, typename KeyFunc, typename KeyType = int,
+                 typename = std::enable_if_t<std::is_invocable_v<KeyFunc, const typename Container::value_type&>>>
+        static void parallel_sort(Container& container, KeyFunc key_func, KeyType min_key, KeyType max_key,
+                                  unsigned threads = 0) {
+            static_assert(std::is_integral_v<KeyType>, "KeyType must be integral");
+            static_assert(detail::is_random_access_v<typename Container::iterator>,
+                          "parallel_sort requires random access iterators");
+            if (min_key > max_key) throw std::invalid_argument("min_key > max_key");
+
+            using value_type = typename Container::value_type;
+            KeyType range = max_key - min_key + 1;
+            if (range <= 0) throw std::invalid_argument("invalid key range");
+
+            std::size_t n = container.size();
+            std::size_t slices = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+            slices = std::min(slices, n / parallel_min_slice);
+            if (slices < 2) {
+                sort(container, key_func, min_key, max_key);
+                return;
+            }
+
+            constexpr std::size_t line = 64 / sizeof(std::size_t);
+            std::size_t keys = static_cast<std::size_t>(range);
+            std::size_t stride = (keys + line - 1) / line * line + line;
+            std::vector<std::size_t> counts(slices * stride, 0);
+            auto first = container.begin();
+
+            detail::run_slices(slices, n, [&](std::size_t t, std::size_t begin, std::size_t end) {
+                std::size_t* row = counts.data() + t * stride;
+                for (std::size_t i = begin; i < end; ++i) {
+                    KeyType k = key_func(first[i]);
+                    if (k < min_key || k > max_key) throw std::out_of_range("key out of expected range");
+                    ++row[static_cast<std::size_t>(k - min_key)];
+                }
+            });
+
+            // Key-major, slice-minor exclusive prefix sum, in place.
+            std::size_t sum = 0;
+            for (std::size_t k = 0; k < keys; ++k) {
+                for (std::size_t t = 0; t < slices; ++t) {
+                    std::size_t count = counts[t * stride + k];
+                    counts[t * stride + k] = sum;
+                    sum += count;
+                }
+            }
+
+            detail::raw_buffer<value_type> buffer(n);
+            value_type* output = buffer.data();
+            // If a copy or key_func throws, slice t has constructed exactly
+            // [start, counts) of every key's output range.
+            constexpr bool may_throw = !std::is_nothrow_copy_constructible_v<value_type> ||
+                                       !std::is_nothrow_invocable_v<KeyFunc&, const value_type&>;
+            std::vector<std::size_t> starts;
+            if constexpr (may_throw) starts = counts;
+            try {
+                detail::run_slices(slices, n, [&](std::size_t t, std::size_t begin, std::size_t end) {
+                    std::size_t* row = counts.data() + t * stride;
+                    for (std::size_t i = begin; i < end; ++i) {
+                        KeyType k = key_func(first[i]);
+                        ::new (static_cast<void*>(output + row[static_cast<std::size_t>(k - min_key)])) value_type(first[i]);
+                        ++row[static_cast<std::size_t>(k - min_key)];
+                    }
+                });
+            } catch (...) {
+                if constexpr (may_throw) {
+                    for (std::size_t t = 0; t < slices; ++t) {
+                        for (std::size_t k = 0; k < keys; ++k) {
+                            std::destroy(output + starts[t * stride + k], output + counts[t * stride + k]);
+                        }
+                    }
+                }
+                throw;
+            }
+            detail::run_slices(slices, n, [&](std::size_t, std::size_t begin, std::size_t end) {
+                try {
+                    std::move(output + begin, output + end, first + begin);
+                } catch (...) {
+                    std::destroy(output + begin, output + end);
+                    throw;
+                }
+                std::destroy(output + begin, output + end);
+            });
+        }
+
+        template<typename T>
+        static typename std::enable_if_t<std::is_integral_v<T>, void>
+        parallel_sort(std::vector<T>& v, T min_key, T max_key, unsigned threads = 0) {
+            parallel_sort(v, [](const T& x) { return x; }, min_key, max_key, threads);
+        }
+
         template<typename T>
         static typename std::enable_if_t<std::is_integral_v<T>, void>
         sort(std::vector<T>& v, T min_key, T max_key) {
@@ -119,8 +920,161 @@ namespace lab {
         void operator()(T(&arr)[N], KeyFunc key_func, KeyType min_key, KeyType max_key) const {
             sort(arr, key_func, min_key, max_key);
         }
+
+        template<typename Range, typename KeyFunc, typename KeyType>
+        void operator()(Range& range, KeyFunc key_func, KeyType min_key, KeyType max_key, CountingMode mode) const {
+            sort(range, key_func, min_key, max_key, mode);
+        }
+
+    private:
+        // Fewest elements per thread worth starting a thread for.
+        static constexpr std::size_t parallel_min_slice = std::size_t(1) << 15;
+
+        // Stores key - min_key of every element in slots and counts the keys;
+        // throws before anything is moved if a key is out of range.
+        template<typename Slot, typename Iterator, typename KeyFunc, typename KeyType>
+        static void extract_keys(Iterator first, std::vector<Slot>& slots, std::vector<std::size_t>& counts,
+                                 KeyFunc& key_func, KeyType min_key, KeyType max_key) {
+            for (std::size_t i = 0; i < slots.size(); ++i) {
+                KeyType k = key_func(first[i]);
+                if (k < min_key || k > max_key) throw std::out_of_range("key out of expected range");
+                slots[i] = static_cast<Slot>(k - min_key);
+                ++counts[slots[i]];
+            }
+        }
+
+        template<typename Slot, typename Range, typename KeyFunc, typename KeyType>
+        static void cached_sort(Range& range, KeyFunc& key_func, KeyType min_key, KeyType max_key) {
+            using value_type = std::decay_t<decltype(*std::begin(range))>;
+            auto first = std::begin(range);
+            std::vector<Slot> slots(static_cast<std::size_t>(std::end(range) - first));
+            std::vector<std::size_t> counts(static_cast<std::size_t>(max_key - min_key) + 1, 0);
+            extract_keys(first, slots, counts, key_func, min_key, max_key);
+
+            std::size_t sum = 0;
+            for (auto& count : counts) {
+                std::size_t c = count;
+                count = sum;
+                sum += c;
+            }
+            for (auto& slot : slots) slot = static_cast<Slot>(counts[slot]++);
+
+            // slots[i] is now where element i goes. Carry each displaced
+            // element along its cycle, marking visited slots as fixed points.
+            for (std::size_t i = 0; i < slots.size(); ++i) {
+                if (slots[i] == i) continue;
+                value_type carry = std::move(first[i]);
+                std::size_t j = slots[i];
+                slots[i] = static_cast<Slot>(i);
+                while (j != i) {
+                    using std::swap;
+                    swap(carry, first[j]);
+                    std::size_t next = slots[j];
+                    slots[j] = static_cast<Slot>(j);
+                    j = next;
+                }
+                first[i] = std::move(carry);
+            }
+        }
+
+        template<typename Slot, typename Range, typename KeyFunc, typename KeyType>
+        static void in_place_sort(Range& range, KeyFunc& key_func, KeyType min_key, KeyType max_key) {
+            auto first = std::begin(range);
+            std::vector<Slot> slots(static_cast<std::size_t>(std::end(range) - first));
+            std::vector<std::size_t> next(static_cast<std::size_t>(max_key - min_key) + 1, 0);
+            extract_keys(first, slots, next, key_func, min_key, max_key);
+
+            std::vector<std::size_t> end(next.size());
+            std::size_t sum = 0;
+            for (std::size_t b = 0; b < next.size(); ++b) {
+                sum += next[b];
+                end[b] = sum;
+                next[b] = sum - next[b];
+            }
+            // Swap the element at the front of bucket b into its own bucket
+            // until the front holds one that belongs to b.
+            for (std::size_t b = 0; b < next.size(); ++b) {
+                while (next[b] < end[b]) {
+                    std::size_t i = next[b];
+                    std::size_t k = slots[i];
+                    if (k == b) {
+                        ++next[b];
+                        continue;
+                    }
+                    std::size_t j = next[k]++;
+                    std::iter_swap(first + i, first + j);
+                    std::swap(slots[i], slots[j]);
+                }
+            }
+        }
     };
 
+    // Function forms of the sorters above, taking a container or an array.
+
+    template<typename Range, typename Compare = std::less<>>
+    void insertion_sort(Range& range, Compare comp = Compare{}) {
+        InsertionSort::sort(std::begin(range), std::end(range), comp);
+    }
+
+    template<typename Range, typename Compare = std::less<>>
+    void pdq_sort(Range& range, Compare comp = Compare{}) {
+        PdqSort::sort(std::begin(range), std::end(range), comp);
+    }
+
+    template<typename Range, typename Compare = std::less<>>
+    void merge_sort(Range& range, Compare comp = Compare{}) {
+        MergeSort::sort(std::begin(range), std::end(range), comp);
+    }
+
+    template<typename Range, typename... Args>
+    void counting_sort(Range& range, Args&&... args) {
+        CountingSort::sort(range, std::forward<Args>(args)...);
+    }
+
+    template<unsigned DigitBits = 8, typename Range, typename... KeyFunc>
+    void radix_sort(Range& range, KeyFunc&&... key_func) {
+        RadixSort::sort<DigitBits>(range, std::forward<KeyFunc>(key_func)...);
+    }
+
+    template<unsigned DigitBits = 8, typename Range, typename... KeyFunc>
+    void msd_radix_sort(Range& range, KeyFunc&&... key_func) {
+        RadixSort::msd_sort<DigitBits>(range, std::forward<KeyFunc>(key_func)...);
+    }
+
+    // Argsort forms: a permutation of Index (uint32_t or uint64_t) values
+    // such that range[perm[0]], range[perm[1]], ... is sorted, for use with
+    // apply_permutation() or to read the range in order without moving it.
+
+    template<typename Index = std::uint32_t, typename Range, typename Compare = std::less<>>
+    std::vector<Index> insertion_argsort(const Range& range, Compare comp = Compare{}) {
+        return InsertionSort::argsort<Index>(std::begin(range), std::end(range), comp);
+    }
+
+    template<typename Index = std::uint32_t, typename Range, typename Compare = std::less<>>
+    std::vector<Index> pdq_argsort(const Range& range, Compare comp = Compare{}) {
+        return PdqSort::argsort<Index>(std::begin(range), std::end(range), comp);
+    }
+
+    template<typename Index = std::uint32_t, typename Range, typename Compare = std::less<>>
+    std::vector<Index> merge_argsort(const Range& range, Compare comp = Compare{}) {
+        return MergeSort::argsort<Index>(std::begin(range), std::end(range), comp);
+    }
+
+    template<typename Index = std::uint32_t, typename Range, typename KeyFunc, typename KeyType>
+    std::vector<Index> counting_argsort(const Range& range, KeyFunc key_func, KeyType min_key, KeyType max_key) {
+        return CountingSort::argsort<Index>(range, key_func, min_key, max_key);
+    }
+
+    template<typename Index = std::uint32_t, unsigned DigitBits = 8, typename Range, typename... KeyFunc>
+    std::vector<Index> radix_argsort(const Range& range, KeyFunc&&... key_func) {
+        return RadixSort::argsort<Index, DigitBits>(range, std::forward<KeyFunc>(key_func)...);
+    }
+
+    template<typename Container, typename... Args>
+    void parallel_counting_sort(Container& container, Args&&... args) {
+        CountingSort::parallel_sort(container, std::forward<Args>(args)...);
+    }
+
 } // namespace lab
 
 #endif // SORTING_HPP
@@ -3,6 +3,13 @@
 #include "../src/include/person.hpp"
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <atomic>
 
 using namespace lab;
 
@@ -90,4 +97,404 @@ TEST(SortingTest, InsertionSortDescending) {
 
     std::vector<int> expected = { 9, 6, 5, 4, 3, 2, 1, 1 };
     EXPECT_EQ(v, expected);
-}
\ No newline at end of file
+}
+
+namespace {
+
+    // Inputs that stress quicksort pivot choice and run detection.
+    std::vector<std::vector<int>> sort_patterns(std::size_t n) {
+        std::mt19937 rng(12345);
+        std::vector<std::vector<int>> patterns;
+        std::vector<int> v(n);
+        for (auto& x : v) x = static_cast<int>(rng());
+        patterns.push_back(v);
+        for (auto& x : v) x = static_cast<int>(rng() % 16);
+        patterns.push_back(v);
+        std::sort(v.begin(), v.end());
+        patterns.push_back(v);
+        std::reverse(v.begin(), v.end());
+        patterns.push_back(v);
+        for (std::size_t i = 0; i < n; ++i) v[i] = static_cast<int>(i < n / 2 ? i : n - i);
+        patterns.push_back(v);
+        for (std::size_t i = 0; i < n; ++i) v[i] = static_cast<int>(i % 97);
+        patterns.push_back(v);
+        std::fill(v.begin(), v.end(), 7);
+        patterns.push_back(v);
+        for (std::size_t i = 0; i < n; ++i) v[i] = static_cast<int>(i);
+        for (std::size_t i = 0; i + 1 < n; i += n / 10 + 1) std::swap(v[i], v[i + 1]);
+        patterns.push_back(v);
+        return patterns;
+    }
+
+    std::vector<Person> sample_people(std::size_t n) {
+        std::mt19937 rng(99);
+        std::vector<Person> people;
+        for (std::size_t i = 0; i < n; ++i) {
+            people.emplace_back("person" + std::to_string(i), static_cast<int>(rng() % 50));
+        }
+        return people;
+    }
+
+}
+
+TEST(SortingTest, PdqSortMatchesStdSort) {
+    for (std::size_t n : { 0, 1, 2, 5, 23, 24, 100, 129, 1000, 100000 }) {
+        for (auto v : sort_patterns(n)) {
+            auto expected = v;
+            std::sort(expected.begin(), expected.end());
+            pdq_sort(v);
+            EXPECT_EQ(v, expected) << "n=" << n;
+        }
+    }
+}
+
+TEST(SortingTest, MergeSortMatchesStdSort) {
+    for (std::size_t n : { 0, 1, 2, 31, 32, 33, 1000, 100000 }) {
+        for (auto v : sort_patterns(n)) {
+            auto expected = v;
+            std::sort(expected.begin(), expected.end());
+            MergeSort{}(v);
+            EXPECT_EQ(v, expected) << "n=" << n;
+        }
+    }
+}
+
+TEST(SortingTest, PdqSortDescendingArray) {
+    int arr[] = { 3, 1, 4, 1, 5, 9, 2, 6 };
+    PdqSort{}(arr, std::greater<int>());
+
+    std::vector<int> expected = { 9, 6, 5, 4, 3, 2, 1, 1 };
+    EXPECT_TRUE(std::equal(std::begin(arr), std::end(arr), expected.begin()));
+}
+
+TEST(SortingTest, PdqSortPersons) {
+    auto people = sample_people(5000);
+    auto expected = people;
+    std::sort(expected.begin(), expected.end());
+    pdq_sort(people);
+    EXPECT_EQ(people, expected);
+}
+
+TEST(SortingTest, MergeSortIsStable) {
+    auto by_age = [](const Person& a, const Person& b) { return a.age() < b.age(); };
+    auto people = sample_people(5000);
+    auto expected = people;
+    std::stable_sort(expected.begin(), expected.end(), by_age);
+    merge_sort(people, by_age);
+    EXPECT_EQ(people, expected);
+}
+
+TEST(SortingTest, SortsMoveOnlyElements) {
+    auto make = [] {
+        std::vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < 300; ++i) v.push_back(std::make_unique<int>((i * 37) % 101));
+        return v;
+    };
+    auto by_value = [](const std::unique_ptr<int>& a, const std::unique_ptr<int>& b) { return *a < *b; };
+    auto sorted = [&](const std::vector<std::unique_ptr<int>>& v) {
+        return std::is_sorted(v.begin(), v.end(), by_value) &&
+               std::all_of(v.begin(), v.end(), [](const auto& p) { return p != nullptr; });
+    };
+
+    auto a = make();
+    insertion_sort(a, by_value);
+    EXPECT_TRUE(sorted(a));
+    auto b = make();
+    pdq_sort(b, by_value);
+    EXPECT_TRUE(sorted(b));
+    auto c = make();
+    merge_sort(c, by_value);
+    EXPECT_TRUE(sorted(c));
+}
+
+TEST(SortingTest, ParallelCountingSortMatchesSerial) {
+    std::mt19937 rng(5);
+    std::vector<std::pair<int, int>> items(300000);
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        items[i] = { static_cast<int>(rng() % 1000) - 500, static_cast<int>(i) };
+    }
+    auto key = [](const std::pair<int, int>& item) { return item.first; };
+    auto expected = items;
+    counting_sort(expected, key, -500, 499);
+
+    for (unsigned threads : { 1u, 2u, 3u, 8u }) {
+        auto v = items;
+        parallel_counting_sort(v, key, -500, 499, threads);
+        EXPECT_EQ(v, expected) << "threads=" << threads;
+    }
+
+    std::vector<int> ints(100000);
+    for (auto& x : ints) x = static_cast<int>(rng() % 7);
+    auto sorted = ints;
+    std::sort(sorted.begin(), sorted.end());
+    CountingSort::parallel_sort(ints, 0, 6, 4);
+    EXPECT_EQ(ints, sorted);
+}
+
+TEST(SortingTest, ParallelCountingSortOutOfRange) {
+    std::vector<int> v(200000, 3);
+    v[150000] = 9;
+    auto original = v;
+    EXPECT_THROW(parallel_counting_sort(v, 0, 6, 4u), std::out_of_range);
+    EXPECT_EQ(v, original);
+}
+
+namespace {
+
+    template<typename T>
+    std::vector<T> random_keys(std::size_t n, unsigned seed) {
+        std::mt19937_64 rng(seed);
+        std::vector<T> v(n);
+        for (auto& x : v) {
+            if constexpr (std::is_floating_point_v<T>) {
+                x = static_cast<T>(std::uniform_real_distribution<double>(-1e9, 1e9)(rng));
+            } else {
+                x = static_cast<T>(rng());
+            }
+        }
+        return v;
+    }
+
+    template<typename T>
+    void expect_radix_sorts(std::size_t n) {
+        auto v = random_keys<T>(n, 3);
+        auto expected = v;
+        std::sort(expected.begin(), expected.end());
+
+        auto lsd = v;
+        radix_sort(lsd);
+        EXPECT_EQ(lsd, expected);
+        auto lsd11 = v;
+        radix_sort<11>(lsd11);
+        EXPECT_EQ(lsd11, expected);
+        auto lsd16 = v;
+        RadixSort::sort<16>(lsd16);
+        EXPECT_EQ(lsd16, expected);
+        auto msd = v;
+        msd_radix_sort(msd);
+        EXPECT_EQ(msd, expected);
+    }
+
+}
+
+TEST(SortingTest, RadixSortKeyTypes) {
+    for (std::size_t n : { 0, 1, 31, 1000, 50000 }) {
+        expect_radix_sorts<std::int8_t>(n);
+        expect_radix_sorts<std::uint16_t>(n);
+        expect_radix_sorts<int>(n);
+        expect_radix_sorts<std::uint32_t>(n);
+        expect_radix_sorts<std::int64_t>(n);
+        expect_radix_sorts<std::uint64_t>(n);
+        expect_radix_sorts<float>(n);
+        expect_radix_sorts<double>(n);
+    }
+}
+
+TEST(SortingTest, RadixSortSpecialValues) {
+    std::vector<double> v = { 0.0, -0.0, 1.5, -1.5, 1e300, -1e300,
+                              std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                              std::numeric_limits<double>::denorm_min(), -std::numeric_limits<double>::denorm_min() };
+    radix_sort(v);
+    EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+    EXPECT_TRUE(std::signbit(v[4]));
+    EXPECT_FALSE(std::signbit(v[5]));
+
+    std::vector<std::int64_t> w = { INT64_MAX, INT64_MIN, -1, 0, 1, INT64_MIN + 1 };
+    msd_radix_sort(w);
+    EXPECT_TRUE(std::is_sorted(w.begin(), w.end()));
+
+    int arr[] = { 3, -1, 4, -1, 5, -9, 2, 6 };
+    RadixSort{}(arr);
+    EXPECT_TRUE(std::is_sorted(std::begin(arr), std::end(arr)));
+}
+
+TEST(SortingTest, RadixSortIsStableByKey) {
+    auto people = sample_people(20000);
+    auto age = [](const Person& p) { return p.age(); };
+    auto expected = people;
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const Person& a, const Person& b) { return a.age() < b.age(); });
+
+    auto lsd = people;
+    radix_sort(lsd, age);
+    EXPECT_EQ(lsd, expected);
+    auto msd = people;
+    msd_radix_sort(msd, age);
+    EXPECT_EQ(msd, expected);
+
+    std::vector<std::pair<std::uint64_t, int>> wide(30000);
+    std::mt19937_64 rng(8);
+    for (std::size_t i = 0; i < wide.size(); ++i) wide[i] = { (rng() % 100) << 40, static_cast<int>(i) };
+    auto wide_expected = wide;
+    std::stable_sort(wide_expected.begin(), wide_expected.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    auto first = [](const std::pair<std::uint64_t, int>& p) { return p.first; };
+    auto wide_lsd = wide;
+    radix_sort<16>(wide_lsd, first);
+    EXPECT_EQ(wide_lsd, wide_expected);
+    msd_radix_sort(wide, first);
+    EXPECT_EQ(wide, wide_expected);
+}
+
+namespace {
+
+    struct Tracked {
+        static inline int copies = 0;
+        int key = 0;
+        std::string payload;
+
+        Tracked() = default;
+        Tracked(int k, std::string p) : key(k), payload(std::move(p)) {}
+        Tracked(const Tracked& other) : key(other.key), payload(other.payload) { ++copies; }
+        Tracked(Tracked&&) noexcept = default;
+        Tracked& operator=(const Tracked& other) {
+            key = other.key;
+            payload = other.payload;
+            ++copies;
+            return *this;
+        }
+        Tracked& operator=(Tracked&&) noexcept = default;
+        bool operator==(const Tracked& other) const { return key == other.key && payload == other.payload; }
+    };
+
+}
+
+TEST(SortingTest, CountingSortCachedMatchesCopy) {
+    auto age = [](const Person& p) { return p.age(); };
+    for (std::size_t n : { 0, 1, 2, 1000, 20000 }) {
+        auto expected = sample_people(n);
+        auto people = expected;
+        counting_sort(expected, age, 0, 49);
+        counting_sort(people, age, 0, 49, CountingMode::cached);
+        EXPECT_EQ(people, expected);
+    }
+
+    int arr[] = { 3, 1, 4, 1, 5, 2, 6 };
+    CountingSort{}(arr, [](int x) { return x; }, 1, 6, CountingMode::cached);
+    EXPECT_TRUE(std::is_sorted(std::begin(arr), std::end(arr)));
+}
+
+TEST(SortingTest, CountingSortInPlaceGroupsKeys) {
+    std::mt19937 rng(4);
+    for (int min_key : { 0, -40000 }) {
+        int max_key = min_key == 0 ? 200 : 40000;
+        std::vector<std::pair<int, int>> v(50000);
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            v[i] = { min_key + static_cast<int>(rng() % static_cast<unsigned>(max_key - min_key + 1)), static_cast<int>(i) };
+        }
+        auto expected = v;
+        std::sort(expected.begin(), expected.end());
+        counting_sort(v, [](const std::pair<int, int>& p) { return p.first; }, min_key, max_key, CountingMode::in_place);
+        EXPECT_TRUE(std::is_sorted(v.begin(), v.end(), [](const auto& a, const auto& b) { return a.first < b.first; }));
+        std::sort(v.begin(), v.end());
+        EXPECT_EQ(v, expected);
+    }
+}
+
+TEST(SortingTest, CountingSortModesDoNotCopy) {
+    std::vector<Tracked> items;
+    for (int i = 0; i < 2000; ++i) items.emplace_back((i * 7919) % 37, std::string(40, char('a' + i % 26)));
+    auto key = [](const Tracked& t) { return t.key; };
+    auto expected = items;
+    counting_sort(expected, key, 0, 36);
+
+    for (CountingMode mode : { CountingMode::cached, CountingMode::in_place }) {
+        auto v = items;
+        Tracked::copies = 0;
+        CountingSort::sort(v, key, 0, 36, mode);
+        EXPECT_EQ(Tracked::copies, 0);
+        if (mode == CountingMode::cached) EXPECT_EQ(v, expected);
+        else EXPECT_TRUE(std::is_sorted(v.begin(), v.end(), [](const Tracked& a, const Tracked& b) { return a.key < b.key; }));
+    }
+}
+
+TEST(SortingTest, ParallelCountingSortCopiesOnce) {
+    std::vector<Tracked> items;
+    for (int i = 0; i < 80000; ++i) items.emplace_back((i * 7919) % 37, std::string(40, char('a' + i % 26)));
+    auto key = [](const Tracked& t) { return t.key; };
+    auto expected = items;
+    counting_sort(expected, key, 0, 36);
+
+    auto v = items;
+    Tracked::copies = 0;
+    parallel_counting_sort(v, key, 0, 36, 2u);
+    EXPECT_EQ(Tracked::copies, static_cast<int>(items.size()));
+    EXPECT_EQ(v, expected);
+
+    // A key function failing halfway through the scatter leaves the input
+    // untouched and destroys the copies made so far.
+    std::atomic<std::size_t> calls{ 0 };
+    auto failing = [&](const Tracked& t) {
+        if (++calls == items.size() * 3 / 2) throw std::runtime_error("key");
+        return t.key;
+    };
+    v = items;
+    EXPECT_THROW(parallel_counting_sort(v, failing, 0, 36, 2u), std::runtime_error);
+    EXPECT_EQ(v, items);
+}
+
+TEST(SortingTest, CountingSortModesOutOfRange) {
+    std::vector<int> v = { 3, 1, 7, 2 };
+    auto id = [](int x) { return x; };
+    EXPECT_THROW(counting_sort(v, id, 1, 6, CountingMode::cached), std::out_of_range);
+    EXPECT_THROW(counting_sort(v, id, 1, 6, CountingMode::in_place), std::out_of_range);
+    EXPECT_EQ(v, std::vector<int>({ 3, 1, 7, 2 }));
+}
+
+TEST(SortingTest, ArgsortsMatchSorts) {
+    auto people = sample_people(3000);
+    auto by_age = [](const Person& a, const Person& b) { return a.age() < b.age(); };
+    auto age = [](const Person& p) { return p.age(); };
+    auto stable = people;
+    std::stable_sort(stable.begin(), stable.end(), by_age);
+    auto gather = [&](const auto& perm) {
+        std::vector<Person> out;
+        for (auto i : perm) out.push_back(people[i]);
+        return out;
+    };
+
+    EXPECT_EQ(gather(insertion_argsort(people, by_age)), stable);
+    EXPECT_EQ(gather(merge_argsort<std::uint64_t>(people, by_age)), stable);
+    EXPECT_EQ(gather(counting_argsort(people, age, 0, 49)), stable);
+    EXPECT_EQ(gather(radix_argsort(people, age)), stable);
+
+    auto pdq = gather(pdq_argsort(people));
+    auto expected = people;
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(pdq, expected);
+
+    std::vector<double> values = { 2.5, -1.0, 7.0, 0.0 };
+    EXPECT_EQ(radix_argsort<std::uint64_t>(values), std::vector<std::uint64_t>({ 1, 3, 0, 2 }));
+
+    int arr[] = { 3, 1, 2 };
+    EXPECT_EQ(InsertionSort::argsort(std::begin(arr), std::end(arr), std::greater<>()),
+              std::vector<std::uint32_t>({ 0, 2, 1 }));
+}
+
+TEST(SortingTest, ApplyPermutationMovesOnce) {
+    std::vector<Tracked> items;
+    for (int i = 0; i < 1000; ++i) items.emplace_back((i * 31) % 101, std::string(30, char('a' + i % 26)));
+    auto perm = counting_argsort(items, [](const Tracked& t) { return t.key; }, 0, 100);
+    std::vector<Tracked> expected;
+    for (auto i : perm) expected.push_back(items[i]);
+
+    Tracked::copies = 0;
+    apply_permutation(items, perm);
+    EXPECT_EQ(Tracked::copies, 0);
+    EXPECT_EQ(items, expected);
+
+    std::vector<int> v = { 10, 20, 30 };
+    apply_permutation(v, std::vector<std::uint32_t>{ 2, 0, 1 });
+    EXPECT_EQ(v, std::vector<int>({ 30, 10, 20 }));
+
+    EXPECT_THROW(apply_permutation(v, std::vector<std::uint32_t>{ 0, 0, 1 }), std::invalid_argument);
+    EXPECT_THROW(apply_permutation(v, std::vector<std::uint32_t>{ 0, 1 }), std::invalid_argument);
+    EXPECT_THROW(apply_permutation(v, std::vector<std::uint32_t>{ 0, 1, 3 }), std::invalid_argument);
+    EXPECT_EQ(v, std::vector<int>({ 30, 10, 20 }));
+}
+
+TEST(SortingTest, ArgsortIndexTooNarrow) {
+    std::vector<int> v(300, 1);
+    EXPECT_THROW(insertion_argsort<std::uint8_t>(v), std::length_error);
+    EXPECT_EQ(insertion_argsort<std::uint8_t>(std::vector<int>(256, 1)).size(), 256u);
+}